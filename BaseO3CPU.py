@@ -47,17 +47,41 @@ from m5.proxy import *
 
 
 class SMTFetchPolicy(ScopedEnum):
-    vals = ["RoundRobin", "Branch", "IQCount", "LSQCount"]
+    vals = ["RoundRobin", "Branch", "IQCount", "LSQCount", "MLP"]
 
 
 class SMTQueuePolicy(ScopedEnum):
-    vals = ["Dynamic", "Partitioned", "Threshold"]
+    vals = ["Dynamic", "Partitioned", "Threshold", "Adaptive"]
+
+
+class SMTPartitionMetric(ScopedEnum):
+    vals = ["Throughput", "HarmonicMean"]
 
 
 class CommitPolicy(ScopedEnum):
     vals = ["RoundRobin", "OldestReady"]
 
 
+class MemDepPredictorType(ScopedEnum):
+    vals = ["StoreSet", "StoreDistance", "Conservative", "Speculative"]
+
+
+class LoadReplayPolicy(ScopedEnum):
+    vals = ["Selective", "Squash"]
+
+
+class IssuePolicy(ScopedEnum):
+    vals = ["OldestFirst", "CriticalFirst"]
+
+
+class IQSteeringPolicy(ScopedEnum):
+    vals = ["Dependence", "LoadBalance"]
+
+
+class RunaheadEngine(ScopedEnum):
+    vals = ["DVR", "PRE", "IMP"]
+
+
 class BaseO3CPU(BaseCPU):
     type = "BaseO3CPU"
     cxx_class = "gem5::o3::CPU"
@@ -81,6 +105,11 @@ class BaseO3CPU(BaseCPU):
         200, "Cache Ports. Constrains stores only."
     )
     cacheLoadPorts = Param.Unsigned(200, "Cache Ports. Constrains loads only.")
+    loadPairing = Param.Bool(
+        False,
+        "Let a load to a line another load is reading this cycle share "
+        "that load's cache access and port",
+    )
 
     decodeToFetchDelay = Param.Cycles(1, "Decode to fetch delay")
     renameToFetchDelay = Param.Cycles(1, "Rename to fetch delay")
@@ -91,6 +120,17 @@ class BaseO3CPU(BaseCPU):
     fetchQueueSize = Param.Unsigned(
         32, "Fetch queue size in micro-ops per-thread"
     )
+    ftqSize = Param.Unsigned(
+        0,
+        "Fetch target queue depth in fetch blocks per-thread, "
+        "0 disables the decoupled frontend",
+    )
+    fdipDistance = Param.Unsigned(
+        4, "Number of FTQ entries ahead of fetch to prefetch into the I-cache"
+    )
+    fetchTargetTableSize = Param.Unsigned(
+        1024, "Number of fetch blocks whose taken exit the FTQ remembers"
+    )
 
     renameToDecodeDelay = Param.Cycles(1, "Rename to decode delay")
     iewToDecodeDelay = Param.Cycles(
@@ -99,6 +139,14 @@ class BaseO3CPU(BaseCPU):
     commitToDecodeDelay = Param.Cycles(1, "Commit to decode delay")
     fetchToDecodeDelay = Param.Cycles(1, "Fetch to decode delay")
     decodeWidth = Param.Unsigned(8, "Decode width")
+    macroOpFusion = Param.Bool(
+        False,
+        "Fuse adjacent dependent integer pairs in decode so each pair "
+        "takes a single decode/rename slot and ROB/IQ entry",
+    )
+    fuseLoads = Param.Bool(
+        True, "Allow a load to be the second half of a fused pair"
+    )
 
     iewToRenameDelay = Param.Cycles(
         1, "Issue/Execute/Writeback to rename delay"
@@ -106,6 +154,16 @@ class BaseO3CPU(BaseCPU):
     commitToRenameDelay = Param.Cycles(1, "Commit to rename delay")
     decodeToRenameDelay = Param.Cycles(1, "Decode to rename delay")
     renameWidth = Param.Unsigned(8, "Rename width")
+    moveElimination = Param.Bool(
+        False,
+        "Eliminate register moves and zero idioms at rename by sharing "
+        "physical registers instead of executing them; RISC-V only",
+    )
+    earlyRegRelease = Param.Bool(
+        False,
+        "Free a physical register once all its readers have executed and "
+        "its redefiner is past every unresolved branch",
+    )
 
     commitToIEWDelay = Param.Cycles(
         1, "Commit to Issue/Execute/Writeback delay"
@@ -120,6 +178,41 @@ class BaseO3CPU(BaseCPU):
     issueWidth = Param.Unsigned(8, "Issue width")
     wbWidth = Param.Unsigned(8, "Writeback width")
     fuPool = Param.FUPool(DefaultFUPool(), "Functional Unit pool")
+    speculativeLoadWakeup = Param.Bool(
+        False, "Wake load dependents assuming an L1 hit"
+    )
+    loadHitLatency = Param.Cycles(
+        4, "Cycles from a load's issue until its dependents are woken"
+    )
+    loadReplayPolicy = Param.LoadReplayPolicy(
+        "Selective",
+        "Replay only the dependents that read their operands before a "
+        "missing load's data, or squash everything after the load",
+    )
+    issuePolicy = Param.IssuePolicy(
+        "OldestFirst",
+        "Issue ready instructions oldest first, or predicted critical "
+        "instructions first",
+    )
+    criticalityTableSize = Param.Unsigned(
+        1024, "Criticality predictor table size"
+    )
+    numIQClusters = Param.Unsigned(
+        1,
+        "Number of IQ clusters, each with an equal share of the IQ entries "
+        "and functional units; 1 leaves the IQ unclustered",
+    )
+    iqSteeringPolicy = Param.IQSteeringPolicy(
+        "Dependence",
+        "Steer instructions to the cluster of an unready operand's "
+        "producer, or to the least occupied cluster",
+    )
+    iqClusterBypassLatency = Param.Cycles(
+        1, "Extra cycles for a result to wake a consumer in another cluster"
+    )
+    iqDVRCluster = Param.Bool(
+        False, "Keep the last IQ cluster for DVR stride load chains"
+    )
 
     iewToCommitDelay = Param.Cycles(
         1, "Issue/Execute/Writeback to commit delay"
@@ -139,6 +232,11 @@ class BaseO3CPU(BaseCPU):
 
     LQEntries = Param.Unsigned(32, "Number of load queue entries")
     SQEntries = Param.Unsigned(32, "Number of store queue entries")
+    writeBufferEntries = Param.Unsigned(
+        0,
+        "Number of line entries in the post-commit coalescing store write "
+        "buffer (0 disables it)",
+    )
     LSQDepCheckShift = Param.Unsigned(
         4, "Number of places to shift addr before check"
     )
@@ -147,13 +245,53 @@ class BaseO3CPU(BaseCPU):
         "Should dependency violations be checked for "
         "loads & stores or just stores",
     )
+    loadValueReexec = Param.Bool(
+        False,
+        "Replace the associative load queue searches with value-based "
+        "re-execution at commit of loads that may have been reordered",
+    )
     store_set_clear_period = Param.Unsigned(
         250000,
         "Number of load/store insts before the dep predictor "
         "should be invalidated",
     )
+    memDepPredictor = Param.MemDepPredictorType(
+        "StoreSet",
+        "Memory dependence predictor (Conservative and Speculative "
+        "bound what prediction can achieve)",
+    )
     LFSTSize = Param.Unsigned(1024, "Last fetched store table size")
     SSITSize = Param.Unsigned(1024, "Store set ID table size")
+    storeDistanceTableSize = Param.Unsigned(
+        1024, "Store distance predictor table size"
+    )
+
+    loadValuePred = Param.Bool(
+        False,
+        "Predict load values at dispatch with a last-value plus stride "
+        "predictor and wake dependents early",
+    )
+    LVPTableSize = Param.Unsigned(1024, "Load value predictor table size")
+    LVPConfidenceThreshold = Param.Unsigned(
+        12, "Confidence (out of 15) needed to use a predicted load value"
+    )
+
+    memRenaming = Param.Bool(
+        False,
+        "Link predicted store-load pairs at rename so the load takes the "
+        "store's data register",
+    )
+    memRenameTableSize = Param.Unsigned(
+        1024, "Memory renaming predictor table size"
+    )
+    numRenameCheckpoints = Param.Unsigned(
+        0,
+        "Rename map checkpoints per thread taken at low confidence "
+        "branches for single-cycle squash recovery (0 disables them)",
+    )
+    branchConfidenceTableSize = Param.Unsigned(
+        1024, "Branch confidence estimator table size"
+    )
 
     numRobs = Param.Unsigned(1, "Number of Reorder Buffers")
 
@@ -170,6 +308,15 @@ class BaseO3CPU(BaseCPU):
     numPhysMatRegs = Param.Unsigned(2, "Number of physical matrix registers")
     # most ISAs don't use condition-code regs, so default is 0
     numPhysCCRegs = Param.Unsigned(0, "Number of physical cc registers")
+    regFileBanks = Param.Unsigned(
+        0, "Number of physical register file banks (0 for unlimited ports)"
+    )
+    regFileReadPorts = Param.Unsigned(
+        2, "Read ports of each physical register file bank"
+    )
+    regFileWritePorts = Param.Unsigned(
+        1, "Write ports of each physical register file bank"
+    )
     numIQEntries = Param.Unsigned(64, "Number of instruction queue entries")
     numROBEntries = Param.Unsigned(192, "Number of reorder buffer entries")
 
@@ -186,8 +333,69 @@ class BaseO3CPU(BaseCPU):
     )
     smtROBThreshold = Param.Int(100, "SMT ROB Threshold Sharing Parameter")
     smtCommitPolicy = Param.CommitPolicy("RoundRobin", "SMT Commit Policy")
+    smtAdaptiveEpoch = Param.Cycles(
+        16384, "Length of an epoch of the Adaptive SMT queue policy"
+    )
+    smtAdaptiveStep = Param.Unsigned(
+        4,
+        "Percent of each Adaptive queue moved to the trial thread of an "
+        "epoch",
+    )
+    smtAdaptiveMetric = Param.SMTPartitionMetric(
+        "Throughput", "Metric the Adaptive SMT queue policy climbs on"
+    )
+    smtMLPThreshold = Param.Cycles(
+        100, "Latency from which a load counts as a long-latency miss for "
+        "the MLP fetch policy"
+    )
+    smtMLPTableSize = Param.Unsigned(
+        256, "Number of loads tracked by the MLP distance predictor"
+    )
+    smtMLPFlush = Param.Bool(
+        False,
+        "Flush a thread past the predicted MLP distance of its "
+        "outstanding miss instead of only stalling its fetch",
+    )
 
     branchPred = Param.BranchPredictor(
         TournamentBP(numThreads=Parent.numThreads), "Branch Predictor"
     )
     needsTSO = Param.Bool(False, "Enable TSO Memory model")
+
+    runaheadEngine = Param.RunaheadEngine(
+        "DVR",
+        "Runahead engine: DVR vector runahead, Precise Runahead on "
+        "full-window stalls, or the Indirect Memory Prefetcher baseline",
+    )
+    dvrLeadDistance = Param.Unsigned(
+        32, "Number of iterations ahead of a stride load that DVR prefetches"
+    )
+    dvrNestedRows = Param.Unsigned(
+        0,
+        "Number of outer loop iterations DVR runs ahead when the inner "
+        "stride loop is shorter than the lead distance; 0 disables nested "
+        "runahead",
+    )
+    preSliceTableSize = Param.Unsigned(
+        128, "Number of load slice PCs tracked by Precise Runahead"
+    )
+    impTableSize = Param.Unsigned(
+        16, "Number of index loads tracked by the Indirect Memory Prefetcher"
+    )
+    impDistance = Param.Unsigned(
+        16,
+        "Number of index elements the Indirect Memory Prefetcher runs "
+        "ahead",
+    )
+
+    branchRunahead = Param.Bool(
+        False,
+        "Override the branch predictor with loop branch outcomes "
+        "precomputed from lane values",
+    )
+    branchRunaheadEntries = Param.Unsigned(
+        64, "Number of branches tracked by branch runahead"
+    )
+    branchRunaheadLanes = Param.Unsigned(
+        32, "Number of iterations ahead branch runahead precomputes"
+    )
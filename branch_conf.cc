@@ -0,0 +1,33 @@
+#include "cpu/o3/branch_conf.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+BranchConfidence::init(unsigned table_size)
+{
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid branch confidence table size!\n");
+    }
+
+    table.assign(table_size, maxCount);
+    indexMask = table_size - 1;
+}
+
+void
+BranchConfidence::trainCorrect(Addr pc)
+{
+    uint8_t &count = table[calcIndex(pc)];
+    if (count < maxCount) {
+        ++count;
+    }
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,59 @@
+#ifndef __CPU_O3_BRANCH_CONF_HH__
+#define __CPU_O3_BRANCH_CONF_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * PC-indexed branch confidence estimator using resetting counters, as in
+ * "Assigning Confidence to Conditional Branch Predictions" by Jacobsen et
+ * al. A counter is cleared when its branch mispredicts and raised when it
+ * commits correctly; a branch is high confidence only once its counter has
+ * saturated. Counters start saturated, so branches are trusted until they
+ * first mispredict.
+ */
+class BranchConfidence
+{
+  public:
+    /** Default constructor.  init() must be called prior to use. */
+    BranchConfidence() { };
+
+    /** Initializes the estimator with the given table size. */
+    void init(unsigned table_size);
+
+    /** Returns whether the branch at the given PC is low confidence. */
+    bool isLowConfidence(Addr pc) const
+    {
+        return table[calcIndex(pc)] < maxCount;
+    }
+
+    /** Records a correctly predicted instance of the branch. */
+    void trainCorrect(Addr pc);
+
+    /** Records a mispredicted instance of the branch. */
+    void trainMispredict(Addr pc) { table[calcIndex(pc)] = 0; }
+
+  private:
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr pc) const { return (pc >> 1) & indexMask; }
+
+    std::vector<uint8_t> table;
+
+    unsigned indexMask;
+
+    /** Saturation value of the counters. */
+    static constexpr uint8_t maxCount = 15;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_BRANCH_CONF_HH__
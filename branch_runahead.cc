@@ -0,0 +1,237 @@
+#include "cpu/o3/branch_runahead.hh"
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst.hh"
+#include "debug/Fetch.hh"
+#include "params/BaseO3CPU.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+BranchRunahead::BranchRunahead(CPU *_cpu, const BaseO3CPUParams &params)
+    : stats(_cpu),
+      cpu(_cpu),
+      _enabled(params.branchRunahead),
+      numLanes(params.branchRunaheadLanes),
+      table(params.branchRunaheadEntries),
+      indexMask(params.branchRunaheadEntries - 1)
+{
+    if (!isPowerOf2(params.branchRunaheadEntries)) {
+        fatal("Invalid branch runahead table size!\n");
+    }
+}
+
+bool
+BranchRunahead::evalCond(int cond, RegVal a, RegVal b)
+{
+    switch (cond) {
+      case Eq: return a == b;
+      case Ne: return a != b;
+      case Lt: return (int64_t)a < (int64_t)b;
+      case Ge: return (int64_t)a >= (int64_t)b;
+      case Ltu: return a < b;
+      case Geu: return a >= b;
+      default: panic("Unknown branch runahead condition %i\n", cond);
+    }
+}
+
+bool
+BranchRunahead::predict(const DynInstPtr &inst, bool bp_taken, bool &taken)
+{
+    if (!inst->isCondCtrl() || !inst->isDirectCtrl())
+        return false;
+
+    Addr pc = inst->pcState().instAddr();
+    Entry &entry = table[calcIndex(pc)];
+    if (!entry.valid || entry.pc != pc ||
+        entry.tid != inst->threadNumber) {
+        return false;
+    }
+
+    entry.inflight.push_back({inst->seqNum, false, bp_taken});
+
+    // The new instance is as many iterations past the last committed one
+    // as there are instances in flight.
+    RegVal lane = entry.inflight.size();
+    if (!entry.synced || entry.conf < confThreshold || !entry.condMask ||
+        lane > numLanes || entry.runEnded) {
+        return false;
+    }
+
+    // Past a loop exit the operands jump to the next run's start, which
+    // the lanes of this run do not know until that run's first commit.
+    if (entry.exitKnown) {
+        for (auto it = entry.inflight.begin();
+             it != std::prev(entry.inflight.end()); ++it) {
+            if (it->taken == entry.exitTaken)
+                return false;
+        }
+    }
+
+    RegVal a = entry.op[0] + lane * entry.step[0];
+    RegVal b = entry.op[1] + lane * entry.step[1];
+
+    // Every comparison still consistent with the branch must agree.
+    int outcomes = 0;
+    for (int cond = 0; cond < NumConds; cond++) {
+        if (entry.condMask & (1 << cond))
+            outcomes |= evalCond(cond, a, b) ? 2 : 1;
+    }
+    if (outcomes == 3)
+        return false;
+
+    taken = outcomes == 2;
+    entry.inflight.back().precomputed = true;
+    entry.inflight.back().taken = taken;
+
+    ++stats.precomputed;
+    if (taken != bp_taken)
+        ++stats.overrides;
+
+    DPRINTF(Fetch, "[tid:%i] [sn:%llu] Branch runahead: PC %#x lane %llu "
+            "(%#x, %#x) precomputed %s\n", inst->threadNumber,
+            inst->seqNum, pc, lane, a, b, taken ? "taken" : "not taken");
+
+    return true;
+}
+
+void
+BranchRunahead::commit(const DynInstPtr &inst)
+{
+    if (!inst->isCondCtrl() || !inst->isDirectCtrl() ||
+        inst->numSrcRegs() < 1 || inst->numSrcRegs() > 2) {
+        return;
+    }
+
+    RegVal op[2] = {0, 0};
+    for (int i = 0; i < inst->numSrcRegs(); i++) {
+        if (!inst->srcRegIdx(i).is(IntRegClass))
+            return;
+        op[i] = cpu->getReg(inst->renamedSrcIdx(i), inst->threadNumber);
+    }
+
+    bool taken = inst->pcState().branching();
+    Addr pc = inst->pcState().instAddr();
+    Entry &entry = table[calcIndex(pc)];
+
+    if (!entry.valid || entry.pc != pc ||
+        entry.tid != inst->threadNumber) {
+        entry = Entry();
+        entry.valid = true;
+        entry.pc = pc;
+        entry.tid = inst->threadNumber;
+        entry.op[0] = op[0];
+        entry.op[1] = op[1];
+        entry.condMask = (1 << NumConds) - 1;
+    } else {
+        RegVal step0 = op[0] - entry.op[0];
+        RegVal step1 = op[1] - entry.op[1];
+        if (step0 == entry.step[0] && step1 == entry.step[1]) {
+            entry.conf = std::min<uint8_t>(entry.conf + 1, maxConf);
+            entry.newStepSeen = false;
+        } else if (entry.newStepSeen && step0 == entry.newStep[0] &&
+                   step1 == entry.newStep[1]) {
+            // The step really changed, so relearn it.
+            entry.step[0] = step0;
+            entry.step[1] = step1;
+            entry.conf = 1;
+            entry.newStepSeen = false;
+        } else {
+            // A one-off jump, such as the induction variable resetting
+            // when a loop is entered again, keeps the learnt step; the
+            // lanes restart from this instance's operands. The instance
+            // before the jump left the loop.
+            entry.newStep[0] = step0;
+            entry.newStep[1] = step1;
+            entry.newStepSeen = true;
+            entry.exitTaken = entry.lastTaken;
+            entry.exitKnown = true;
+        }
+        entry.op[0] = op[0];
+        entry.op[1] = op[1];
+    }
+
+    entry.lastTaken = taken;
+    entry.runEnded = entry.exitKnown && taken == entry.exitTaken;
+
+    for (int cond = 0; cond < NumConds; cond++) {
+        if (evalCond(cond, op[0], op[1]) != taken)
+            entry.condMask &= ~(1 << cond);
+    }
+
+    // Once a tracked instance commits, every older instance has too, so
+    // the in-flight count is the lane of the next fetched instance.
+    if (!entry.inflight.empty() &&
+        entry.inflight.front().seqNum == inst->seqNum) {
+        const Instance &instance = entry.inflight.front();
+        if (instance.precomputed) {
+            if (instance.taken == taken)
+                ++stats.correct;
+            else
+                ++stats.incorrect;
+        }
+        entry.inflight.pop_front();
+        entry.synced = true;
+    }
+}
+
+void
+BranchRunahead::squash(InstSeqNum squashed_sn, ThreadID tid)
+{
+    for (auto &entry : table) {
+        if (!entry.valid || entry.tid != tid)
+            continue;
+
+        while (!entry.inflight.empty() &&
+               entry.inflight.back().seqNum > squashed_sn) {
+            entry.inflight.pop_back();
+        }
+    }
+}
+
+void
+BranchRunahead::squash(InstSeqNum squashed_sn, bool taken, ThreadID tid)
+{
+    squash(squashed_sn, tid);
+
+    for (auto &entry : table) {
+        if (!entry.valid || entry.tid != tid || entry.inflight.empty())
+            continue;
+
+        if (entry.inflight.back().seqNum == squashed_sn) {
+            entry.inflight.back().taken = taken;
+            return;
+        }
+    }
+}
+
+BranchRunahead::BranchRunaheadStats::BranchRunaheadStats(
+        statistics::Group *parent)
+    : statistics::Group(parent, "branchRunahead"),
+      ADD_STAT(precomputed, statistics::units::Count::get(),
+               "Number of branches with an outcome precomputed from lanes"),
+      ADD_STAT(overrides, statistics::units::Count::get(),
+               "Number of precomputed outcomes that overrode the branch "
+               "predictor"),
+      ADD_STAT(correct, statistics::units::Count::get(),
+               "Number of precomputed outcomes committed correct"),
+      ADD_STAT(incorrect, statistics::units::Count::get(),
+               "Number of precomputed outcomes committed incorrect")
+{
+    precomputed.prereq(precomputed);
+    overrides.prereq(overrides);
+    correct.prereq(correct);
+    incorrect.prereq(incorrect);
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,166 @@
+#ifndef __CPU_O3_BRANCH_RUNAHEAD_HH__
+#define __CPU_O3_BRANCH_RUNAHEAD_HH__
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/o3/dyn_inst_ptr.hh"
+
+namespace gem5
+{
+
+struct BaseO3CPUParams;
+
+namespace o3
+{
+
+class CPU;
+
+/**
+ * Branch runahead: precomputes the outcomes of upcoming instances of
+ * loop-closing and other chain-dependent conditional branches, and
+ * overrides the branch predictor with them at fetch.
+ *
+ * The operands of such a branch advance by a fixed step per iteration,
+ * the same way DVR lanes advance the stride load chain, so the operands
+ * of the instance k iterations ahead are known: base + k * step. Each
+ * tracked branch learns its operand steps and which comparison it
+ * performs from its committed instances, then evaluates that comparison
+ * on the lane values of every newly fetched instance up to a number of
+ * lanes ahead. A loop exit is thus fetched down the right path instead
+ * of costing a flush at the end of every short inner loop.
+ */
+class BranchRunahead
+{
+  public:
+    BranchRunahead(CPU *_cpu, const BaseO3CPUParams &params);
+
+    /** Whether branch runahead is enabled. */
+    bool enabled() const { return _enabled; }
+
+    /**
+     * Looks up a fetched conditional branch.
+     * @param inst The branch being fetched.
+     * @param bp_taken The branch predictor's direction.
+     * @param taken Set to the precomputed direction on a hit.
+     * @return Whether the outcome of this instance is known.
+     */
+    bool predict(const DynInstPtr &inst, bool bp_taken, bool &taken);
+
+    /** Trains on a committed branch, reading its operand values. */
+    void commit(const DynInstPtr &inst);
+
+    /** Forgets the fetched instances younger than squashed_sn. */
+    void squash(InstSeqNum squashed_sn, ThreadID tid);
+
+    /** Forgets the fetched instances younger than a mispredicted branch
+     * and records the direction it resolved to.
+     */
+    void squash(InstSeqNum squashed_sn, bool taken, ThreadID tid);
+
+    struct BranchRunaheadStats : public statistics::Group
+    {
+        BranchRunaheadStats(statistics::Group *parent);
+
+        /** Stat for the number of instances with a precomputed outcome. */
+        statistics::Scalar precomputed;
+        /** Stat for the number of those the predictor had wrong. */
+        statistics::Scalar overrides;
+        /** Stat for the number of precomputed outcomes that committed
+         * correct.
+         */
+        statistics::Scalar correct;
+        /** Stat for the number of precomputed outcomes that were wrong. */
+        statistics::Scalar incorrect;
+    } stats;
+
+  private:
+    /** Comparisons a conditional branch may perform on its operands. */
+    enum Cond
+    {
+        Eq, Ne, Lt, Ge, Ltu, Geu,
+        NumConds
+    };
+
+    /** Evaluates a comparison on a pair of operand values. */
+    static bool evalCond(int cond, RegVal a, RegVal b);
+
+    /** A fetched instance of a tracked branch that has yet to commit. */
+    struct Instance
+    {
+        InstSeqNum seqNum;
+        bool precomputed;
+        /** Direction fetch followed. */
+        bool taken;
+    };
+
+    struct Entry
+    {
+        bool valid = false;
+        Addr pc = 0;
+        ThreadID tid = 0;
+
+        /** Operand values of the last committed instance. */
+        RegVal op[2] = {0, 0};
+        /** Per-iteration step of each operand. */
+        RegVal step[2] = {0, 0};
+        /** A different step seen on the last commit, which replaces the
+         * learnt one if the next commit repeats it.
+         */
+        RegVal newStep[2] = {0, 0};
+        bool newStepSeen = false;
+        /** Commits the steps have held for. */
+        uint8_t conf = 0;
+        /** Direction of the last committed instance. */
+        bool lastTaken = false;
+        /** Direction that leaves the loop, learnt from the instance
+         * before an operand jump.
+         */
+        bool exitTaken = false;
+        bool exitKnown = false;
+        /** Whether the last committed instance left the loop, so op
+         * belongs to a run that has ended.
+         */
+        bool runEnded = false;
+        /** Comparisons consistent with every committed outcome. */
+        uint8_t condMask = 0;
+        /** Whether every older in-flight instance is in inflight. */
+        bool synced = false;
+
+        /** In-flight instances, oldest first. */
+        std::deque<Instance> inflight;
+    };
+
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr pc) const { return (pc >> 1) & indexMask; }
+
+    CPU *cpu;
+
+    bool _enabled;
+
+    /** How many iterations ahead outcomes are precomputed. */
+    unsigned numLanes;
+
+    std::vector<Entry> table;
+
+    unsigned indexMask;
+
+    /** Commits with an unchanged step before lanes are trusted. Only a
+     * new branch or a changed step has to build it up: re-entering a
+     * loop keeps the step and its confidence, so a later run of a short
+     * inner loop is precomputed once its first instance commits.
+     */
+    static constexpr uint8_t confThreshold = 2;
+
+    /** Saturation value of the step confidence. */
+    static constexpr uint8_t maxConf = 3;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_BRANCH_RUNAHEAD_HH__
@@ -147,6 +147,11 @@ struct TimeStruct
         unsigned dispatched;
         bool usedIQ;
         bool usedLSQ;
+
+        /** Whether the thread has fetched as far past its outstanding
+         * long-latency miss as that miss has MLP to exploit.
+         */
+        bool mlpStall;
     };
 
     IewComm iewInfo[MaxThreads];
@@ -42,8 +42,10 @@
 #include "cpu/o3/commit.hh"
 
 #include <algorithm>
+#include <cstring>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/compiler.hh"
 #include "base/loader/symtab.hh"
@@ -63,6 +65,8 @@
 #include "debug/ExecFaulting.hh"
 #include "debug/HtmCpu.hh"
 #include "debug/O3PipeView.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
 #include "params/BaseO3CPU.hh"
 #include "sim/faults.hh"
 #include "sim/full_system.hh"
@@ -96,6 +100,7 @@ Commit::Commit(CPU *_cpu, const BaseO3CPUParams &params)
       trapLatency(params.trapLatency),
       canHandleInterrupts(true),
       avoidQuiesceLiveLock(false),
+      loadValueReexec(params.loadValueReexec),
       stats(_cpu, this)
 {
     if (commitWidth > MaxWidth)
@@ -122,8 +127,11 @@ Commit::Commit(CPU *_cpu, const BaseO3CPUParams &params)
         pc[tid].reset(params.isa[0]->newPCState());
         youngestSeqNum[tid] = 0;
         lastCommitedSeqNum[tid] = 0;
+        lastStalledHead[tid] = 0;
         trapInFlight[tid] = false;
         committedStores[tid] = false;
+        committedStoreStamp[tid] = 0;
+        lastExecutedStore[tid] = nullptr;
         checkEmptyROB[tid] = false;
         renameMap[tid] = nullptr;
         htmStarts[tid] = 0;
@@ -165,13 +173,22 @@ Commit::CommitStats::CommitStats(CPU *cpu, Commit *commit)
       ADD_STAT(committedInstType, statistics::units::Count::get(),
                "Class of committed instruction"),
       ADD_STAT(commitEligibleSamples, statistics::units::Cycle::get(),
-               "number cycles where commit BW limit reached")
+               "number cycles where commit BW limit reached"),
+      ADD_STAT(loadsReexecuted, statistics::units::Count::get(),
+               "Number of possibly reordered loads re-executed at commit"),
+      ADD_STAT(loadReexecMismatches, statistics::units::Count::get(),
+               "Number of re-executed loads that read a different value"),
+      ADD_STAT(loadReexecStallCycles, statistics::units::Cycle::get(),
+               "Number of cycles loads waited on stores to re-execute")
 {
     using namespace statistics;
 
     commitSquashedInsts.prereq(commitSquashedInsts);
     commitNonSpecStalls.prereq(commitNonSpecStalls);
     branchMispredicts.prereq(branchMispredicts);
+    loadsReexecuted.prereq(loadsReexecuted);
+    loadReexecMismatches.prereq(loadReexecMismatches);
+    loadReexecStallCycles.prereq(loadReexecStallCycles);
 
     numCommittedDist
         .init(0,commit->commitWidth,1)
@@ -294,6 +311,7 @@ Commit::clearStates(ThreadID tid)
     tcSquash[tid] = false;
     pc[tid].reset(cpu->tcBase(tid)->getIsaPtr()->newPCState());
     lastCommitedSeqNum[tid] = 0;
+    lastStalledHead[tid] = 0;
     squashAfterInst[tid] = NULL;
 }
 
@@ -577,6 +595,58 @@ Commit::squashAfter(ThreadID tid, const DynInstPtr &head_inst)
     squashAfterInst[tid] = head_inst;
 }
 
+void
+Commit::updateRunahead(ThreadID tid)
+{
+    PreciseRunahead &pre = cpu->preciseRunahead;
+
+    if (pre.isActive(tid)) {
+        if (commitStatus[tid] != Running) {
+            // Any other squash also discards the runahead instructions,
+            // since they are younger than everything in the ROB.
+            pre.exit(tid);
+        } else if (rob->readHeadInst(tid)->isExecuted()) {
+            pre.exit(tid);
+            squashRunahead(tid);
+        }
+    } else if (commitStatus[tid] == Running && rob->isFull(tid)) {
+        const DynInstPtr &head_inst = rob->readHeadInst(tid);
+
+        if (head_inst->isLoad() && head_inst->isIssued() &&
+            !head_inst->isExecuted() && !head_inst->isSquashed()) {
+            pre.enter(tid, head_inst);
+        }
+    }
+}
+
+void
+Commit::squashRunahead(ThreadID tid)
+{
+    DynInstPtr tail_inst = rob->readTailInst(tid);
+
+    DPRINTF(Commit, "[tid:%i] Runahead done, squashing after ROB tail "
+            "[sn:%llu], restarting at PC %s\n", tid, tail_inst->seqNum,
+            tail_inst->readPredTarg());
+
+    commitStatus[tid] = ROBSquashing;
+
+    // Nothing in the ROB is younger than its tail, so the ROB finishes
+    // squashing at once and the window is kept.
+    rob->squash(youngestSeqNum[tid], tid);
+    changedROBNumEntries[tid] = true;
+
+    toIEW->commitInfo[tid].doneSeqNum = youngestSeqNum[tid];
+    toIEW->commitInfo[tid].squash = true;
+    toIEW->commitInfo[tid].robSquashing = true;
+    toIEW->commitInfo[tid].mispredictInst = NULL;
+    // Lets fetch resume inside the tail's macro-op if it is one.
+    toIEW->commitInfo[tid].squashInst = tail_inst;
+
+    set(toIEW->commitInfo[tid].pc, tail_inst->readPredTarg());
+
+    cpu->activityThisCycle();
+}
+
 void
 Commit::tick()
 {
@@ -637,6 +707,11 @@ Commit::tick()
 
             ppCommitStall->notify(inst);
 
+            if (inst->seqNum != lastStalledHead[tid]) {
+                lastStalledHead[tid] = inst->seqNum;
+                iewStage->instQueue.trainCriticality(inst, true);
+            }
+
             DPRINTF(Commit,"[tid:%i] Can't commit, Instruction [sn:%llu] PC "
                     "%s is head of ROB and not ready\n",
                     tid, inst->seqNum, inst->pcState());
@@ -811,7 +886,8 @@ Commit::commit()
             // number as the youngest instruction in the ROB.
             youngestSeqNum[tid] = squashed_inst;
 
-            rob->squash(squashed_inst, tid);
+            rob->squash(squashed_inst, tid,
+                        renameStage->hasCheckpoint(squashed_inst, tid));
             changedROBNumEntries[tid] = true;
 
             toIEW->commitInfo[tid].doneSeqNum = squashed_inst;
@@ -838,6 +914,10 @@ Commit::commit()
             set(toIEW->commitInfo[tid].pc, fromIEW->pc[tid]);
         }
 
+        if (cpu->preciseRunahead.enabled()) {
+            updateRunahead(tid);
+        }
+
         if (commitStatus[tid] == ROBSquashing) {
             num_squashing_threads++;
         }
@@ -1035,6 +1115,10 @@ Commit::commitInsts()
                 // Keep track of the last sequence number commited
                 lastCommitedSeqNum[tid] = head_inst->seqNum;
 
+                if (head_inst->seqNum != lastStalledHead[tid]) {
+                    iewStage->instQueue.trainCriticality(head_inst, false);
+                }
+
                 // If this is an instruction that doesn't play nicely with
                 // others squash everything and restart fetch
                 if (head_inst->isSquashAfter())
@@ -1183,6 +1267,9 @@ Commit::commitHead(const DynInstPtr &head_inst, unsigned inst_num)
         return false;
     }
 
+    if (loadValueReexec && !reexecuteLoad(head_inst, inst_num))
+        return false;
+
     // Check if the instruction caused a fault.  If so, trap.
     Fault inst_fault = head_inst->getFault();
 
@@ -1275,6 +1362,12 @@ Commit::commitHead(const DynInstPtr &head_inst, unsigned inst_num)
 
     updateComInstStats(head_inst);
 
+    if (loadValueReexec && head_inst->isStore() &&
+        head_inst->storeStamp > committedStoreStamp[tid]) {
+        committedStoreStamp[tid] = head_inst->storeStamp;
+        lastExecutedStore[tid] = head_inst;
+    }
+
     DPRINTF(Commit,
             "[tid:%i] [sn:%llu] Committing instruction with PC %s\n",
             tid, head_inst->seqNum, head_inst->pcState());
@@ -1315,6 +1408,25 @@ Commit::commitHead(const DynInstPtr &head_inst, unsigned inst_num)
     if (head_inst->isStore() || head_inst->isAtomic())
         committedStores[tid] = true;
 
+    if (cpu->branchRunahead.enabled() && head_inst->isCondCtrl()) {
+        cpu->branchRunahead.commit(head_inst);
+    }
+
+    if (cpu->smtPartitioner.enabled()) {
+        cpu->smtPartitioner.commitInst(tid);
+    }
+
+    if (iewStage->mlpFetch) {
+        bool long_latency = head_inst->isLoad() &&
+            head_inst->firstIssue != -1 &&
+            head_inst->lastWakeDependents != -1 &&
+            cpu->ticksToCycles(head_inst->lastWakeDependents -
+                               head_inst->firstIssue) >=
+                iewStage->mlpPred.longLatency();
+        iewStage->mlpPred.commitInst(tid, head_inst->pcState().instAddr(),
+                                     long_latency);
+    }
+
     // 在指令提交时检查分支指令
     if (head_inst->isDirectCtrl() && head_inst->pcState().instAddr() == 0x101ae) {
         printf("DVR: Committing branch at PC 0x101ae\n");
@@ -1336,6 +1448,75 @@ Commit::commitHead(const DynInstPtr &head_inst, unsigned inst_num)
     return true;
 }
 
+bool
+Commit::reexecuteLoad(const DynInstPtr &head_inst, unsigned inst_num)
+{
+    ThreadID tid = head_inst->threadNumber;
+
+    if (!head_inst->isLoad() || head_inst->isAtomic() ||
+        head_inst->isDataPrefetch() || head_inst->strictlyOrdered() ||
+        head_inst->getFault() != NoFault || !head_inst->readPredicate() ||
+        !head_inst->readMemAccPredicate()) {
+        return true;
+    }
+
+    // Every committed store is older than the load, so one that executed
+    // after it may have written its address after it was read.
+    bool reordered = head_inst->storeStamp < committedStoreStamp[tid];
+    bool snooped = iewStage->ldstQueue.snoopedSince(head_inst);
+
+    if (!reordered && !snooped)
+        return true;
+
+    // Memory holds the value of every older store once they have drained.
+    if (inst_num > 0 || iewStage->hasStoresToWB(tid)) {
+        ++stats.loadReexecStallCycles;
+        return false;
+    }
+
+    ++stats.loadsReexecuted;
+
+    // Pages are at least this large on every ISA, so a load within one
+    // such block reads a single physical range. Page-crossing and LL
+    // loads are simply refetched.
+    const Addr min_page_bytes = 4096;
+    unsigned size = head_inst->effSize;
+    bool match = false;
+
+    if (head_inst->memData && !(head_inst->memReqFlags & Request::LLSC) &&
+        (head_inst->effAddr % min_page_bytes) + size <= min_page_bytes) {
+        RequestPtr req = std::make_shared<Request>(head_inst->physEffAddr,
+                size, 0, cpu->dataRequestorId());
+        std::vector<uint8_t> data(size);
+        Packet pkt(req, MemCmd::ReadReq);
+        pkt.dataStatic(data.data());
+        cpu->getDataPort().sendFunctional(&pkt);
+
+        match = std::memcmp(data.data(), head_inst->memData, size) == 0;
+    }
+
+    if (match) {
+        // Stop the load from being checked again if commit stalls on it.
+        head_inst->storeStamp = committedStoreStamp[tid];
+        head_inst->snoopStamp = iewStage->ldstQueue.numSnoops(tid);
+        return true;
+    }
+
+    ++stats.loadReexecMismatches;
+
+    DPRINTF(Commit, "[tid:%i] [sn:%llu] Re-executed load PC %s read a "
+            "different value, refetching it.\n", tid, head_inst->seqNum,
+            head_inst->pcState());
+
+    // Train the dependence predictor on the store that resolved last, so
+    // the load waits for it next time.
+    if (reordered && lastExecutedStore[tid])
+        iewStage->instQueue.violation(lastExecutedStore[tid], head_inst);
+
+    head_inst->fault = std::make_shared<ReExec>();
+    return true;
+}
+
 void
 Commit::getInsts()
 {
@@ -1348,6 +1529,14 @@ Commit::getInsts()
         const DynInstPtr &inst = fromRename->insts[inst_num];
         ThreadID tid = inst->threadNumber;
 
+        // Precise Runahead instructions run outside the ROB.
+        if (inst->isRunahead()) {
+            DPRINTF(Commit, "[tid:%i] [sn:%llu] Runahead instruction PC %s, "
+                    "not inserting into ROB.\n",
+                    tid, inst->seqNum, inst->pcState());
+            continue;
+        }
+
         if (!inst->isSquashed() &&
             commitStatus[tid] != ROBSquashing &&
             commitStatus[tid] != TrapPending) {
@@ -64,6 +64,7 @@ struct BaseO3CPUParams;
 namespace o3
 {
 
+class Rename;
 class ThreadState;
 
 /**
@@ -163,6 +164,14 @@ class Commit
      */
     IEW *iewStage;
 
+    /** Sets the pointer to the rename stage. */
+    void setRenameStage(Rename *rename_stage) { renameStage = rename_stage; }
+
+    /** The pointer to the rename stage. Used to check whether a squash can
+     * recover from a rename map checkpoint.
+     */
+    Rename *renameStage;
+
     /** Sets pointer to list of active threads. */
     void setActiveThreads(std::list<ThreadID> *at_ptr);
 
@@ -275,6 +284,17 @@ class Commit
      */
     void squashAfter(ThreadID tid, const DynInstPtr &head_inst);
 
+    /**
+     * Enters Precise Runahead when the ROB is full behind a load still
+     * waiting on memory, and leaves it once that load has executed.
+     */
+    void updateRunahead(ThreadID tid);
+
+    /** Squashes the runahead instructions, which are all younger than
+     * the ROB, and restarts fetch right after the ROB tail.
+     */
+    void squashRunahead(ThreadID tid);
+
     /** Handles processing an interrupt. */
     void handleInterrupt();
 
@@ -289,6 +309,14 @@ class Commit
      */
     bool commitHead(const DynInstPtr &head_inst, unsigned inst_num);
 
+    /**
+     * Re-executes the head load if a store executed after it or a snoop
+     * arrived since, comparing the value it loaded with memory. On a
+     * mismatch the load is given a ReExec fault.
+     * @return Whether the load may commit this cycle.
+     */
+    bool reexecuteLoad(const DynInstPtr &head_inst, unsigned inst_num);
+
     /** Gets instructions from rename and inserts them into the ROB. */
     void getInsts();
 
@@ -429,12 +457,23 @@ class Commit
     /** The sequence number of the last commited instruction. */
     InstSeqNum lastCommitedSeqNum[MaxThreads];
 
+    /** The sequence number of the last instruction that stalled commit
+     * at the head of the ROB.
+     */
+    InstSeqNum lastStalledHead[MaxThreads];
+
     /** Records if there is a trap currently in flight. */
     bool trapInFlight[MaxThreads];
 
     /** Records if there were any stores committed this cycle. */
     bool committedStores[MaxThreads];
 
+    /** Latest execution stamp of any committed store. */
+    uint64_t committedStoreStamp[MaxThreads];
+
+    /** The committed store that executed last, blamed for mismatches. */
+    DynInstPtr lastExecutedStore[MaxThreads];
+
     /** Records if commit should check if the ROB is truly empty (see
         commit_impl.hh). */
     bool checkEmptyROB[MaxThreads];
@@ -454,6 +493,9 @@ class Commit
         a possible livelock senario.  */
     bool avoidQuiesceLiveLock;
 
+    /** Whether loads are checked by value re-execution at commit. */
+    bool loadValueReexec;
+
     /** Updates commit stats based on this instruction. */
     void updateComInstStats(const DynInstPtr &inst);
 
@@ -490,6 +532,15 @@ class Commit
 
         /** Number of cycles where the commit bandwidth limit is reached. */
         statistics::Scalar commitEligibleSamples;
+
+        /** Stat for the number of loads re-executed at commit. */
+        statistics::Scalar loadsReexecuted;
+        /** Stat for the number of re-executed loads whose value changed. */
+        statistics::Scalar loadReexecMismatches;
+        /** Stat for the number of cycles a load waited on older stores to
+         * drain before re-executing.
+         */
+        statistics::Scalar loadReexecStallCycles;
     } stats;
 };
 
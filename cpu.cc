@@ -115,7 +115,11 @@ CPU::CPU(const BaseO3CPUParams &params)
       system(params.system),
       lastRunningCycle(curCycle()),
       cpuStats(this),
-      taintScoreboard(regFile.totalNumPhysRegs())
+      taintScoreboard(regFile.totalNumPhysRegs()),
+      preciseRunahead(this, params),
+      branchRunahead(this, params),
+      indirectPrefetcher(this, params),
+      smtPartitioner(this, params)
 {
     fatal_if(FullSystem && params.numThreads > 1,
             "SMT is not supported in O3 in full system mode currently.");
@@ -175,6 +179,7 @@ CPU::CPU(const BaseO3CPUParams &params)
     commit.setRenameQueue(&renameQueue);
 
     commit.setIEWStage(&iew);
+    commit.setRenameStage(&rename);
     rename.setIEWStage(&iew);
     rename.setCommitStage(&commit);
 
@@ -257,6 +262,21 @@ CPU::CPU(const BaseO3CPUParams &params)
         }
     }
 
+    // Reserve a physical register that always reads as zero for rename
+    // to map eliminated zero idioms onto. It holds a permanent extra
+    // reference so that releasing those mappings never frees it.
+    if (params.moveElimination) {
+        fatal_if(!freeList.hasFreeRegs(IntRegClass),
+                "Not enough physical registers to reserve a zero register "
+                "for move elimination, consider increasing "
+                "numPhysIntRegs\n");
+        PhysRegIdPtr zero_reg = freeList.getReg(IntRegClass);
+        freeList.addReference(zero_reg);
+        regFile.setReg(zero_reg, (RegVal)0);
+        scoreboard.setReg(zero_reg);
+        rename.setZeroReg(zero_reg);
+    }
+
     rename.setRenameMap(renameMap);
     commit.setRenameMap(commitRenameMap);
     rename.setFreeList(&freeList);
@@ -321,6 +341,14 @@ CPU::CPU(const BaseO3CPUParams &params)
 
     // 设置 TaintScoreboard 的 CPU 指针
     taintScoreboard.setCPU(this);
+
+    if (preciseRunahead.enabled())
+        taintScoreboard.initSliceTable(params.preSliceTableSize);
+
+    if (params.regFileBanks) {
+        regFile.initBanks(params.regFileBanks, params.regFileReadPorts,
+                          params.regFileWritePorts);
+    }
 }
 
 void
@@ -386,6 +414,9 @@ CPU::tick()
 
     commit.tick();
 
+    if (smtPartitioner.enabled())
+        smtPartitioner.tick();
+
     // Now advance the time buffers
     timeBuffer.advance();
 
@@ -711,6 +742,10 @@ CPU::processInterrupts(const Fault &interrupt)
 void
 CPU::trap(const Fault &fault, ThreadID tid, const StaticInstPtr &inst)
 {
+    // Early released registers are still the committed mapping of
+    // their architectural registers, so their values go back first.
+    rename.restoreReleasedRegs(tid);
+
     // Pass the thread's TC into the invoke method.
     fault->invoke(threadContexts[tid], inst);
 }
@@ -51,6 +51,7 @@
 
 #include "arch/generic/pcstate.hh"
 #include "base/statistics.hh"
+#include "cpu/o3/branch_runahead.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/commit.hh"
 #include "cpu/o3/decode.hh"
@@ -58,10 +59,13 @@
 #include "cpu/o3/fetch.hh"
 #include "cpu/o3/free_list.hh"
 #include "cpu/o3/iew.hh"
+#include "cpu/o3/imp.hh"
 #include "cpu/o3/limits.hh"
 #include "cpu/o3/rename.hh"
 #include "cpu/o3/rob.hh"
+#include "cpu/o3/runahead.hh"
 #include "cpu/o3/scoreboard.hh"
+#include "cpu/o3/smt_partition.hh"
 #include "cpu/o3/thread_state.hh"
 #include "cpu/activity.hh"
 #include "cpu/base.hh"
@@ -609,6 +613,35 @@ class CPU : public BaseCPU
         taintScoreboard.taintReg(reg, pc);
     }
 
+    /** Precise Runahead engine state, used when it replaces DVR. */
+    PreciseRunahead preciseRunahead;
+
+    /** Loop branch outcomes precomputed for fetch. */
+    BranchRunahead branchRunahead;
+
+    /** Indirect Memory Prefetcher, used when it replaces DVR. */
+    IndirectMemPrefetcher indirectPrefetcher;
+
+    /** Whether DVR is the runahead engine, and so tracks taint chains. */
+    bool
+    dvrRunahead() const
+    {
+        return !preciseRunahead.enabled() && !indirectPrefetcher.enabled();
+    }
+
+    /** Moves the committed mapping of an architectural register onto a
+     * physical register holding the same value.
+     */
+    void
+    remapCommittedReg(const RegId &arch_reg, PhysRegIdPtr phys_reg,
+                      ThreadID tid)
+    {
+        commitRenameMap[tid].setEntry(arch_reg, phys_reg);
+    }
+
+    /** Per-thread shares of the queues under the Adaptive policy. */
+    SMTPartitioner smtPartitioner;
+
     // 获取指定 PC 的 stride 值
     int getStrideValue(Addr pc) const;
 
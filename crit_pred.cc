@@ -0,0 +1,48 @@
+#include "cpu/o3/crit_pred.hh"
+
+#include <algorithm>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/CritPred.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+CriticalityPredictor::init(const std::string &name, unsigned table_size)
+{
+    _name = name;
+
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid criticality predictor table size!\n");
+    }
+
+    table.assign(table_size, 0);
+    indexMask = table_size - 1;
+}
+
+void
+CriticalityPredictor::trainCritical(Addr pc)
+{
+    uint8_t &count = table[calcIndex(pc)];
+    count = std::min<unsigned>(count + criticalIncrement, maxCount);
+
+    DPRINTF(CritPred, "PC %#x trained critical, counter %u.\n", pc, count);
+}
+
+void
+CriticalityPredictor::trainNonCritical(Addr pc)
+{
+    uint8_t &count = table[calcIndex(pc)];
+    if (count > 0) {
+        --count;
+    }
+}
+
+} // namespace o3
+} // namespace gem5
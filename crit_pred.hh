@@ -0,0 +1,74 @@
+#ifndef __CPU_O3_CRIT_PRED_HH__
+#define __CPU_O3_CRIT_PRED_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * PC-indexed instruction criticality predictor. Each entry is a small
+ * saturating counter that is raised when an instance of the instruction
+ * stalls commit at the head of the ROB or wakes many dependents, and
+ * lowered when an instance commits without stalling. Instructions whose
+ * counter is in the upper half are predicted critical.
+ */
+class CriticalityPredictor
+{
+  public:
+    /** Default constructor.  init() must be called prior to use. */
+    CriticalityPredictor() { };
+
+    /** Initializes the predictor with the given table size. */
+    void init(const std::string &name, unsigned table_size);
+
+    /** Returns whether the instruction at the given PC is predicted
+     * critical.
+     */
+    bool isCritical(Addr pc) const
+    {
+        return table[calcIndex(pc)] >= threshold;
+    }
+
+    /** Trains an instruction towards critical. */
+    void trainCritical(Addr pc);
+
+    /** Trains an instruction towards non-critical. */
+    void trainNonCritical(Addr pc);
+
+    /** Name of the predictor, for DPRINTF. */
+    const std::string &name() const { return _name; }
+
+  private:
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr pc) const { return (pc >> 1) & indexMask; }
+
+    std::string _name;
+
+    std::vector<uint8_t> table;
+
+    unsigned indexMask;
+
+    /** Saturation value of the counters. */
+    static constexpr uint8_t maxCount = 7;
+
+    /** Counter value from which an instruction is predicted critical. */
+    static constexpr uint8_t threshold = 4;
+
+    /** Amount a critical event raises the counter by. Critical events
+     * are rarer than non-critical commits, so they weigh more.
+     */
+    static constexpr uint8_t criticalIncrement = 2;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_CRIT_PRED_HH__
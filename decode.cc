@@ -68,6 +68,8 @@ Decode::Decode(CPU *_cpu, const BaseO3CPUParams &params)
       commitToDecodeDelay(params.commitToDecodeDelay),
       fetchToDecodeDelay(params.fetchToDecodeDelay),
       decodeWidth(params.decodeWidth),
+      macroOpFusion(params.macroOpFusion),
+      fuseLoads(params.fuseLoads),
       numThreads(params.numThreads),
       stats(_cpu)
 {
@@ -141,7 +143,14 @@ Decode::DecodeStats::DecodeStats(CPU *cpu)
       ADD_STAT(decodedInsts, statistics::units::Count::get(),
                "Number of instructions handled by decode"),
       ADD_STAT(squashedInsts, statistics::units::Count::get(),
-               "Number of squashed instructions handled by decode")
+               "Number of squashed instructions handled by decode"),
+      ADD_STAT(fusedPairs, statistics::units::Count::get(),
+               "Number of instruction pairs fused into one macro-op"),
+      ADD_STAT(fusedLoadPairs, statistics::units::Count::get(),
+               "Number of fused pairs whose second half is a load"),
+      ADD_STAT(fusionRate, statistics::units::Ratio::get(),
+               "Fraction of decoded instructions that were fused",
+               2 * fusedPairs / decodedInsts)
 {
     idleCycles.prereq(idleCycles);
     blockedCycles.prereq(blockedCycles);
@@ -153,6 +162,8 @@ Decode::DecodeStats::DecodeStats(CPU *cpu)
     controlMispred.prereq(controlMispred);
     decodedInsts.prereq(decodedInsts);
     squashedInsts.prereq(squashedInsts);
+    fusedPairs.prereq(fusedPairs);
+    fusedLoadPairs.prereq(fusedLoadPairs);
 }
 
 void
@@ -547,6 +558,7 @@ Decode::tick()
     bool status_change = false;
 
     toRenameIndex = 0;
+    fusedThisCycle = 0;
 
     list<ThreadID>::iterator threads = activeThreads->begin();
     list<ThreadID>::iterator end = activeThreads->end();
@@ -646,7 +658,8 @@ Decode::decodeInsts(ThreadID tid)
 
     DPRINTF(Decode, "[tid:%i] Sending instruction to rename.\n",tid);
 
-    while (insts_available > 0 && toRenameIndex < decodeWidth) {
+    while (insts_available > 0 && toRenameIndex < MaxWidth &&
+           toRenameIndex - fusedThisCycle < decodeWidth) {
         assert(!insts_to_decode.empty());
 
         DynInstPtr inst = std::move(insts_to_decode.front());
@@ -686,6 +699,40 @@ Decode::decodeInsts(ThreadID tid)
         ++stats.decodedInsts;
         --insts_available;
 
+        // Fuse the next instruction into this one if they form an
+        // eligible pair. The tail is sent right behind its head and
+        // shares the head's decode slot.
+        if (macroOpFusion && insts_available > 0 &&
+            toRenameIndex < MaxWidth &&
+            canFuse(inst, insts_to_decode.front())) {
+            DynInstPtr tail = std::move(insts_to_decode.front());
+            insts_to_decode.pop();
+
+            DPRINTF(Decode, "[tid:%i] Fusing [sn:%lli] PC %s into "
+                    "[sn:%lli] PC %s\n", tid, tail->seqNum,
+                    tail->pcState(), inst->seqNum, inst->pcState());
+
+            inst->setFusedHead();
+            tail->setFusedTail();
+
+            toRename->insts[toRenameIndex] = tail;
+
+            ++(toRename->size);
+            ++toRenameIndex;
+            ++fusedThisCycle;
+            ++stats.decodedInsts;
+            ++stats.fusedPairs;
+            if (tail->isLoad())
+                ++stats.fusedLoadPairs;
+            --insts_available;
+
+#if TRACING_ON
+            if (debug::O3PipeView) {
+                tail->decodeTick = curTick() - tail->fetchTick;
+            }
+#endif
+        }
+
 #if TRACING_ON
         if (debug::O3PipeView) {
             inst->decodeTick = curTick() - inst->fetchTick;
@@ -747,5 +794,41 @@ Decode::decodeInsts(ThreadID tid)
     }
 }
 
+bool
+Decode::canFuse(const DynInstPtr &head, const DynInstPtr &tail) const
+{
+    if (tail->isSquashed() || head->threadNumber != tail->threadNumber)
+        return false;
+
+    // The head must be a plain integer op that can neither redirect
+    // fetch nor fault, so the pair can only be split by squashing the
+    // tail.
+    if (head->opClass() != IntAluOp || head->isControl() ||
+        head->isMemRef() || head->isMicroop() || head->isSerializing() ||
+        head->isNonSpeculative() || head->readPredTaken() ||
+        head->numDestRegs() != 1) {
+        return false;
+    }
+
+    bool tail_is_load = tail->isLoad() && !tail->isAtomic() &&
+        !tail->isStoreConditional() && !tail->isDataPrefetch();
+    if ((tail->opClass() != IntAluOp && !(fuseLoads && tail_is_load)) ||
+        tail->isControl() || tail->isMicroop() || tail->isSerializing() ||
+        tail->isNonSpeculative() || tail->numDestRegs() != 1) {
+        return false;
+    }
+
+    const RegId &link = head->destRegIdx(0);
+    if (!link.is(IntRegClass) || tail->destRegIdx(0) != link)
+        return false;
+
+    for (int i = 0; i < tail->numSrcRegs(); i++) {
+        if (tail->srcRegIdx(i) == link)
+            return true;
+    }
+
+    return false;
+}
+
 } // namespace o3
 } // namespace gem5
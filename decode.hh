@@ -196,6 +196,14 @@ class Decode
      */
     void squash(const DynInstPtr &inst, ThreadID tid);
 
+    /** Returns if two adjacent instructions can be fused into a single
+     * macro-op. The head must be a simple single-destination integer op
+     * and the tail must consume and overwrite the head's destination, so
+     * the intermediate value is dead outside the pair (e.g. lui+addi,
+     * auipc+ld, slli+add, add+lw).
+     */
+    bool canFuse(const DynInstPtr &head, const DynInstPtr &tail) const;
+
   public:
     /** Squashes due to commit signalling a squash. Changes status to
      * squashing and clears block/unblock signals as needed.
@@ -273,6 +281,17 @@ class Decode
     /** Index of instructions being sent to rename. */
     unsigned toRenameIndex;
 
+    /** Number of fused tails sent to rename this cycle. Fused tails ride
+     * along with their head and do not use up a decode slot.
+     */
+    unsigned fusedThisCycle;
+
+    /** Whether adjacent instruction pairs are fused. */
+    bool macroOpFusion;
+
+    /** Whether the tail of a fused pair may be a load. */
+    bool fuseLoads;
+
     /** number of Active Threads*/
     ThreadID numThreads;
 
@@ -320,6 +339,12 @@ class Decode
         statistics::Scalar decodedInsts;
         /** Stat for total number of squashed instructions. */
         statistics::Scalar squashedInsts;
+        /** Stat for number of macro-op fused pairs. */
+        statistics::Scalar fusedPairs;
+        /** Stat for number of fused pairs whose tail is a load. */
+        statistics::Scalar fusedLoadPairs;
+        /** Fraction of decoded instructions that are part of a pair. */
+        statistics::Formula fusionRate;
     } stats;
 };
 
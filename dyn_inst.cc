@@ -318,6 +318,15 @@ DynInst::markSrcRegReady(RegIndex src_idx)
     markSrcRegReady();
 }
 
+void
+DynInst::markSrcRegNotReady(RegIndex src_idx)
+{
+    assert(readySrcIdx(src_idx) && readyRegs > 0);
+    readySrcIdx(src_idx, false);
+    --readyRegs;
+    clearCanIssue();
+}
+
 
 void
 DynInst::setSquashed()
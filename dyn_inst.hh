@@ -189,6 +189,14 @@ class DynInst : public ExecContext, public RefCounted
         HtmFromTransaction,
         NoCapableFU,           /// Processor does not have capability to
                                /// execute the instruction
+        FusedHead,             /// First half of a macro-op fused pair
+        FusedTail,             /// Second half of a macro-op fused pair
+        Eliminated,            /// Move or zero idiom resolved at rename
+        ValuePredLookup,       /// Holds an unresolved value predictor lookup
+        ValuePredicted,        /// Dependents were woken with a predicted value
+        MemRenamed,            /// Load shares its store's data register
+        Critical,              /// Predicted critical, issued with priority
+        Runahead,              /// Precise Runahead slice inst, not in ROB
         MaxFlags
     };
 
@@ -342,12 +350,32 @@ class DynInst : public ExecContext, public RefCounted
     /** The memory request flags (from translation). */
     unsigned memReqFlags = 0;
 
+    /** Stores the LSQ had executed when this load executed, or the
+     * order in which this store executed. Used by value-based load
+     * re-execution.
+     */
+    uint64_t storeStamp = 0;
+
+    /** Snoops the LSQ had seen when this load executed. */
+    uint64_t snoopStamp = 0;
+
     /** The size of the request */
     unsigned effSize;
 
     /** Pointer to the data for the memory access. */
     uint8_t *memData = nullptr;
 
+    /** The value written to the destination at dispatch if the load's
+     * value was predicted.
+     */
+    RegVal predictedValue = 0;
+
+    /** The value a memory renamed load actually read. It is kept here
+     * rather than written back, since the destination register belongs
+     * to the store the load was renamed to.
+     */
+    RegVal loadedValue = 0;
+
     /** Load queue index. */
     ssize_t lqIdx = -1;
     typename LSQUnit::LQIterator lqIt;
@@ -383,6 +411,55 @@ class DynInst : public ExecContext, public RefCounted
     bool notAnInst() const { return instFlags[NotAnInst]; }
     void setNotAnInst() { instFlags[NotAnInst] = true; }
 
+    /** Is this instruction the first half of a fused pair. */
+    bool isFusedHead() const { return instFlags[FusedHead]; }
+    void setFusedHead() { instFlags[FusedHead] = true; }
+
+    /** Is this instruction the second half of a fused pair. The tail
+     * shares its head's ROB and IQ entry, so it does not take a slot of
+     * its own in either structure.
+     */
+    bool isFusedTail() const { return instFlags[FusedTail]; }
+    void setFusedTail() { instFlags[FusedTail] = true; }
+
+    /**
+     * Whether rename resolved this instruction by remapping its
+     * destination onto an existing physical register (a register move
+     * or a zero idiom). Eliminated instructions bypass the IQ and the
+     * functional units and complete at dispatch.
+     */
+    bool isEliminated() const { return instFlags[Eliminated]; }
+    void setEliminated() { instFlags[Eliminated] = true; }
+
+    /** Whether this load looked up the value predictor and has yet to
+     * train or release its entry.
+     */
+    bool hasValuePredLookup() const { return instFlags[ValuePredLookup]; }
+    void valuePredLookup(bool f) { instFlags[ValuePredLookup] = f; }
+
+    /** Whether this load's dependents were woken with predictedValue. */
+    bool isValuePredicted() const { return instFlags[ValuePredicted]; }
+    void setValuePredicted() { instFlags[ValuePredicted] = true; }
+
+    /** Whether rename mapped this load's destination onto the data
+     * register of the store it is predicted to read from.
+     */
+    bool isMemRenamed() const { return instFlags[MemRenamed]; }
+    void setMemRenamed() { instFlags[MemRenamed] = true; }
+
+    /** Whether the IQ issues this instruction ahead of older
+     * non-critical ones.
+     */
+    bool isCritical() const { return instFlags[Critical]; }
+    void setCritical() { instFlags[Critical] = true; }
+
+    /** Whether this instruction was renamed in Precise Runahead mode. It
+     * holds IQ entries and physical registers but is never placed in the
+     * ROB or the LSQ, and is squashed when runahead ends.
+     */
+    bool isRunahead() const { return instFlags[Runahead]; }
+    void setRunahead() { instFlags[Runahead] = true; }
+
 
     ////////////////////////////////////////////
     //
@@ -729,6 +806,11 @@ class DynInst : public ExecContext, public RefCounted
     /** Marks a specific register as ready. */
     void markSrcRegReady(RegIndex src_idx);
 
+    /** Marks a specific register as no longer ready, for an instruction
+     * that was woken speculatively and must wait for the real value.
+     */
+    void markSrcRegNotReady(RegIndex src_idx);
+
     /** Sets this instruction as completed. */
     void setCompleted() { status.set(Completed); }
 
@@ -1009,6 +1091,14 @@ class DynInst : public ExecContext, public RefCounted
     int32_t storeTick = -1;
 #endif
 
+    /** IQ cluster the instruction was steered to. */
+    unsigned iqCluster = 0;
+
+    /** Cycle from which the operands woken from other IQ clusters have
+     * arrived over the bypass.
+     */
+    Cycles clusterReadyCycle = Cycles(0);
+
     /* Values used by LoadToUse stat */
     Tick firstIssue = -1;
     Tick lastWakeDependents = -1;
@@ -1155,6 +1245,10 @@ class DynInst : public ExecContext, public RefCounted
         const PhysRegIdPtr reg = renamedDestIdx(idx);
         if (reg->is(InvalidRegClass))
             return;
+        if (isMemRenamed()) {
+            loadedValue = val;
+            return;
+        }
         cpu->setReg(reg, val, threadNumber);
         setResult(reg->regClass(), val);
     }
@@ -98,7 +98,10 @@ Fetch::Fetch(CPU *_cpu, const BaseO3CPUParams &params)
       numThreads(params.numThreads),
       numFetchingThreads(params.smtNumFetchingThreads),
       icachePort(this, _cpu),
-      finishTranslationEvent(this), fetchStats(_cpu, this)
+      finishTranslationEvent(this),
+      ftqSize(params.ftqSize),
+      fdipDistance(params.fdipDistance),
+      fetchStats(_cpu, this)
 {
     if (numThreads > MaxThreads)
         fatal("numThreads (%d) is larger than compiled limit (%d),\n"
@@ -129,6 +132,18 @@ Fetch::Fetch(CPU *_cpu, const BaseO3CPUParams &params)
         fetchBufferValid[i] = false;
         lastIcacheStall[i] = 0;
         issuePipelinedIfetch[i] = false;
+        ftqNextPC[i] = 0;
+        ftqActive[i] = false;
+        ftqXlateVaddr[i] = 0;
+        ftqXlatePaddr[i] = 0;
+        ftqXlateValid[i] = false;
+        lastPrefetchLine[i] = MaxAddr;
+    }
+
+    if (ftqSize) {
+        fatal_if(!params.fetchTargetTableSize,
+                 "The FTQ needs a fetch target table.\n");
+        fetchTargetTable.resize(params.fetchTargetTableSize);
     }
 
     branchPred = params.branchPred;
@@ -189,6 +204,14 @@ Fetch::FetchStatGroup::FetchStatGroup(CPU *cpu, Fetch *fetch)
              "Number of outstanding Icache misses that were squashed"),
     ADD_STAT(tlbSquashes, statistics::units::Count::get(),
              "Number of outstanding ITLB misses that were squashed"),
+    ADD_STAT(ftqPrefetches, statistics::units::Count::get(),
+             "Number of I-cache lines prefetched ahead of fetch from the "
+             "fetch target queue"),
+    ADD_STAT(ftqPrefetchesUntranslated, statistics::units::Count::get(),
+             "Number of FTQ prefetches dropped because their page had no "
+             "known translation"),
+    ADD_STAT(ftqResyncs, statistics::units::Count::get(),
+             "Number of times fetch diverged from the fetch target queue"),
     ADD_STAT(nisnDist, statistics::units::Count::get(),
              "Number of instructions fetched each cycle (Total)"),
     ADD_STAT(idleRate, statistics::units::Ratio::get(),
@@ -225,6 +248,12 @@ Fetch::FetchStatGroup::FetchStatGroup(CPU *cpu, Fetch *fetch)
             .prereq(icacheSquashes);
         tlbSquashes
             .prereq(tlbSquashes);
+        ftqPrefetches
+            .prereq(ftqPrefetches);
+        ftqPrefetchesUntranslated
+            .prereq(ftqPrefetchesUntranslated);
+        ftqResyncs
+            .prereq(ftqResyncs);
         nisnDist
             .init(/* base value */ 0,
               /* last value */ fetch->fetchWidth,
@@ -283,6 +312,9 @@ Fetch::clearStates(ThreadID tid)
     fetchBufferPC[tid] = 0;
     fetchBufferValid[tid] = false;
     fetchQueue[tid].clear();
+    ftq[tid].clear();
+    ftqActive[tid] = false;
+    ftqXlateValid[tid] = false;
 
     // TODO not sure what to do with priorityList for now
     // priorityList.push_back(tid);
@@ -315,6 +347,10 @@ Fetch::resetStage()
 
         fetchQueue[tid].clear();
 
+        ftq[tid].clear();
+        ftqActive[tid] = false;
+        ftqXlateValid[tid] = false;
+
         priorityList.push_back(tid);
     }
 
@@ -500,6 +536,23 @@ Fetch::lookupAndUpdateNextPC(const DynInstPtr &inst, PCStateBase &next_pc)
     predict_taken = branchPred->predict(inst->staticInst, inst->seqNum,
                                         next_pc, tid);
 
+    bool runahead_taken;
+    if (cpu->branchRunahead.enabled() &&
+        cpu->branchRunahead.predict(inst, predict_taken, runahead_taken) &&
+        runahead_taken != predict_taken) {
+        // The outcome is known from the branch's lane values. Steer fetch
+        // there, and correct the direction the predictor just pushed into
+        // its history so later predictions see the path actually fetched.
+        if (runahead_taken) {
+            set(next_pc, *inst->branchTarget());
+        } else {
+            set(next_pc, inst->pcState());
+            inst->staticInst->advancePC(next_pc);
+        }
+        branchPred->squash(inst->seqNum, next_pc, runahead_taken, tid);
+        predict_taken = runahead_taken;
+    }
+
     if (predict_taken) {
         DPRINTF(Fetch, "[tid:%i] [sn:%llu] Branch at PC %#x "
                 "predicted to be taken to %s\n",
@@ -615,6 +668,10 @@ Fetch::finishTranslation(const Fault &fault, const RequestPtr &mem_req)
         fetchBufferValid[tid] = false;
         DPRINTF(Fetch, "Fetch: Doing instruction read.\n");
 
+        ftqXlateVaddr[tid] = fetchBufferBlockPC;
+        ftqXlatePaddr[tid] = mem_req->getPaddr();
+        ftqXlateValid[tid] = true;
+
         fetchStats.cacheLines++;
 
         // Access the cache.
@@ -723,6 +780,11 @@ Fetch::doSquash(const PCStateBase &new_pc, const DynInstPtr squashInst,
     // Empty fetch queue
     fetchQueue[tid].clear();
 
+    // Restart the FTQ down the corrected path.
+    ftq[tid].clear();
+    ftqNextPC[tid] = new_pc.instAddr();
+    ftqActive[tid] = true;
+
     // microops are being squashed, it is not known wheather the
     // youngest non-squashed microop was  marked delayed commit
     // or not. Setting the flag to true ensures that the
@@ -866,6 +928,15 @@ Fetch::tick()
         }
     }
 
+    // Let the FTQ run ahead of fetch, and prefetch the blocks it holds
+    // so that they are in the I-cache by the time fetch gets there.
+    if (ftqSize) {
+        for (auto tid : *activeThreads) {
+            fillFTQ(tid);
+            issueFTQPrefetches(tid);
+        }
+    }
+
     // Send instructions enqueued into the fetch queue to decode.
     // Limit rate by fetchWidth.  Stall if decode is stalled.
     unsigned insts_to_decode = 0;
@@ -950,6 +1021,18 @@ Fetch::checkSignalsAndUpdate(ThreadID tid)
                               tid);
         }
 
+        if (cpu->branchRunahead.enabled()) {
+            if (fromCommit->commitInfo[tid].mispredictInst &&
+                fromCommit->commitInfo[tid].mispredictInst->isControl()) {
+                cpu->branchRunahead.squash(
+                        fromCommit->commitInfo[tid].doneSeqNum,
+                        fromCommit->commitInfo[tid].branchTaken, tid);
+            } else {
+                cpu->branchRunahead.squash(
+                        fromCommit->commitInfo[tid].doneSeqNum, tid);
+            }
+        }
+
         return true;
     } else if (fromCommit->commitInfo[tid].doneSeqNum) {
         // Update the branch predictor if it wasn't a squashed instruction
@@ -972,6 +1055,17 @@ Fetch::checkSignalsAndUpdate(ThreadID tid)
                               tid);
         }
 
+        if (cpu->branchRunahead.enabled()) {
+            if (fromDecode->decodeInfo[tid].branchMispredict) {
+                cpu->branchRunahead.squash(
+                        fromDecode->decodeInfo[tid].doneSeqNum,
+                        fromDecode->decodeInfo[tid].branchTaken, tid);
+            } else {
+                cpu->branchRunahead.squash(
+                        fromDecode->decodeInfo[tid].doneSeqNum, tid);
+            }
+        }
+
         if (fetchStatus[tid] != Squashing) {
 
             DPRINTF(Fetch, "Squashing from decode with PC = %s\n",
@@ -1099,6 +1193,10 @@ Fetch::fetch(bool &status_change)
 
     bool inRom = isRomMicroPC(this_pc.microPC());
 
+    if (ftqSize && fetchStatus[tid] == Running && !inRom && !macroop[tid]) {
+        syncFTQ(tid, fetchAddr);
+    }
+
     // If returning from the delay of a cache miss, then update the status
     // to running, otherwise do the cache access.  Possibly move this up
     // to tick() function.
@@ -1267,6 +1365,10 @@ Fetch::fetch(bool &status_change)
             predictedBranch |= lookupAndUpdateNextPC(instruction, *next_pc);
             if (predictedBranch) {
                 DPRINTF(Fetch, "Branch detected with PC = %s\n", this_pc);
+                if (ftqSize && !instruction->isMicroop()) {
+                    trainFetchTarget(this_pc.instAddr(),
+                                     next_pc->instAddr());
+                }
             }
 
             newMacro |= this_pc.instAddr() != next_pc->instAddr();
@@ -1372,6 +1474,8 @@ Fetch::getFetchingThread()
             return lsqCount();
           case SMTFetchPolicy::Branch:
             return branchCount();
+          case SMTFetchPolicy::MLP:
+            return mlpCount();
           default:
             return InvalidThreadID;
         }
@@ -1501,6 +1605,47 @@ Fetch::branchCount()
     return InvalidThreadID;
 }
 
+ThreadID
+Fetch::mlpCount()
+{
+    //sorted from lowest->highest
+    std::priority_queue<unsigned, std::vector<unsigned>,
+                        std::greater<unsigned> > PQ;
+    std::map<unsigned, ThreadID> threadMap;
+
+    std::list<ThreadID>::iterator threads = activeThreads->begin();
+    std::list<ThreadID>::iterator end = activeThreads->end();
+
+    while (threads != end) {
+        ThreadID tid = *threads++;
+
+        // A thread stalled on an isolated miss, or one that has already
+        // exposed the MLP of its miss, would only clog the shared queues.
+        if (fromIEW->iewInfo[tid].mlpStall) {
+            DPRINTF(Fetch, "[tid:%i] Fetch gated on MLP distance.\n", tid);
+            continue;
+        }
+
+        unsigned iqCount = fromIEW->iewInfo[tid].iqCount;
+
+        PQ.push(iqCount);
+        threadMap[iqCount] = tid;
+    }
+
+    while (!PQ.empty()) {
+        ThreadID high_pri = threadMap[PQ.top()];
+
+        if (fetchStatus[high_pri] == Running ||
+            fetchStatus[high_pri] == IcacheAccessComplete ||
+            fetchStatus[high_pri] == Idle)
+            return high_pri;
+        else
+            PQ.pop();
+    }
+
+    return InvalidThreadID;
+}
+
 void
 Fetch::pipelineIcacheAccesses(ThreadID tid)
 {
@@ -1530,6 +1675,149 @@ Fetch::pipelineIcacheAccesses(ThreadID tid)
     }
 }
 
+void
+Fetch::trainFetchTarget(Addr branch_pc, Addr target)
+{
+    Addr block = fetchBufferAlignPC(branch_pc);
+    FetchTargetEntry &entry =
+        fetchTargetTable[(block / fetchBufferSize) % fetchTargetTable.size()];
+
+    entry.valid = true;
+    entry.block = block;
+    entry.branchPC = branch_pc;
+    entry.target = target;
+}
+
+void
+Fetch::syncFTQ(ThreadID tid, Addr fetch_addr)
+{
+    auto contains = [fetch_addr](const FetchTarget &target) {
+        return target.start <= fetch_addr && fetch_addr < target.end;
+    };
+
+    auto &queue = ftq[tid];
+
+    if (!queue.empty() && contains(queue.front())) {
+        return;
+    }
+
+    // Fetch moved on to the next predicted block.
+    if (queue.size() > 1 && contains(queue[1])) {
+        queue.pop_front();
+        return;
+    }
+
+    // Fetch left the path the FTQ predicted, so everything in it is
+    // useless. Start over from where fetch is now.
+    if (!queue.empty() || (ftqActive[tid] && ftqNextPC[tid] != fetch_addr)) {
+        DPRINTF(Fetch, "[tid:%i] FTQ diverged from fetch at %#x, "
+                "restarting.\n", tid, fetch_addr);
+        ++fetchStats.ftqResyncs;
+    }
+
+    queue.clear();
+    ftqNextPC[tid] = fetch_addr;
+    ftqActive[tid] = true;
+}
+
+void
+Fetch::fillFTQ(ThreadID tid)
+{
+    if (!ftqActive[tid] || ftq[tid].size() >= ftqSize) {
+        return;
+    }
+
+    Addr start = ftqNextPC[tid];
+    Addr block = fetchBufferAlignPC(start);
+    Addr end = block + fetchBufferSize;
+    Addr next = end;
+
+    // A block that was last left through a taken branch is cut off
+    // after the branch and followed by the branch target; any other
+    // block falls through to the next one.
+    const FetchTargetEntry &entry =
+        fetchTargetTable[(block / fetchBufferSize) % fetchTargetTable.size()];
+    if (entry.valid && entry.block == block && entry.branchPC >= start) {
+        end = entry.branchPC + 1;
+        next = entry.target;
+    }
+
+    ftq[tid].push_back({start, end, false});
+    ftqNextPC[tid] = next;
+
+    DPRINTF(Fetch, "[tid:%i] FTQ entry %#x-%#x added, next %#x "
+            "(size=%i).\n", tid, start, end, next, ftq[tid].size());
+}
+
+void
+Fetch::issueFTQPrefetches(ThreadID tid)
+{
+    if (!ftqXlateValid[tid]) {
+        return;
+    }
+
+    // Prefetches are translated with the last instruction fetch
+    // translation, so they may only cover addresses in the same page.
+    // 4KiB is the smallest page size of any supported ISA.
+    const Addr region_mask = ~(Addr(4096) - 1);
+    const Addr line_mask = ~(cacheBlkSize - 1);
+    const Addr fetch_line = fetchBufferPC[tid] & line_mask;
+
+    unsigned distance = 0;
+    for (auto &target : ftq[tid]) {
+        if (distance++ >= fdipDistance || cacheBlocked) {
+            break;
+        }
+
+        if (target.prefetched) {
+            continue;
+        }
+
+        Addr line = target.start & line_mask;
+        if (line == fetch_line || line == lastPrefetchLine[tid]) {
+            target.prefetched = true;
+            continue;
+        }
+
+        if ((line & region_mask) != (ftqXlateVaddr[tid] & region_mask)) {
+            target.prefetched = true;
+            ++fetchStats.ftqPrefetchesUntranslated;
+            continue;
+        }
+
+        Addr paddr = (ftqXlatePaddr[tid] & region_mask) | (line & ~region_mask);
+        if (!cpu->system->isMemAddr(paddr)) {
+            target.prefetched = true;
+            continue;
+        }
+
+        RequestPtr req = std::make_shared<Request>(
+            line, cacheBlkSize, Request::INST_FETCH | Request::PREFETCH,
+            cpu->instRequestorId(), target.start,
+            cpu->thread[tid]->contextId());
+        req->setPaddr(paddr);
+        req->taskId(cpu->taskId());
+
+        PacketPtr pkt = new Packet(req, MemCmd::SoftPFReq);
+        pkt->allocate();
+
+        if (!icachePort.sendTimingReq(pkt)) {
+            // Out of MSHRs; the cache will send a retry, at which point
+            // both demand fetches and prefetches may go again.
+            delete pkt;
+            cacheBlocked = true;
+            break;
+        }
+
+        DPRINTF(Fetch, "[tid:%i] FDIP prefetch of line %#x for FTQ "
+                "entry %#x.\n", tid, line, target.start);
+
+        target.prefetched = true;
+        lastPrefetchLine[tid] = line;
+        ++fetchStats.ftqPrefetches;
+    }
+}
+
 void
 Fetch::profileStall(ThreadID tid)
 {
@@ -1586,6 +1874,13 @@ Fetch::IcachePort::recvTimingResp(PacketPtr pkt)
     // We shouldn't ever get a cacheable block in Modified state
     assert(pkt->req->isUncacheable() ||
            !(pkt->cacheResponding() && !pkt->hasSharers()));
+
+    // FDIP prefetches only warm the cache, nobody waits for them.
+    if (pkt->req->isPrefetch()) {
+        delete pkt;
+        return true;
+    }
+
     fetch->processCacheCompletion(pkt);
 
     return true;
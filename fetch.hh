@@ -383,12 +383,34 @@ class Fetch
      * policy. */
     ThreadID branchCount();
 
+    /** Returns the appropriate thread to fetch using the MLP-aware policy:
+     * IQ count order, skipping threads that have fetched as far past
+     * their outstanding miss as it has MLP to exploit.
+     */
+    ThreadID mlpCount();
+
     /** Pipeline the next I-cache access to the current one. */
     void pipelineIcacheAccesses(ThreadID tid);
 
     /** Profile the reasons of fetch stall. */
     void profileStall(ThreadID tid);
 
+    /** Records that the fetch block containing branch_pc left through a
+     * predicted taken branch to target, so that the FTQ can follow it.
+     */
+    void trainFetchTarget(Addr branch_pc, Addr target);
+
+    /** Aligns the head of the FTQ with the address fetch is about to
+     * fetch from, restarting the FTQ there if it went down another path.
+     */
+    void syncFTQ(ThreadID tid, Addr fetch_addr);
+
+    /** Appends the next predicted fetch block to the FTQ. */
+    void fillFTQ(ThreadID tid);
+
+    /** Prefetches the I-cache lines of upcoming FTQ entries (FDIP). */
+    void issueFTQPrefetches(ThreadID tid);
+
   private:
     /** Pointer to the O3CPU. */
     CPU *cpu;
@@ -530,6 +552,57 @@ class Fetch
     /** Event used to delay fault generation of translation faults */
     FinishTranslationEvent finishTranslationEvent;
 
+    /** A fetch target: the address range of one predicted fetch block. */
+    struct FetchTarget
+    {
+        Addr start;
+        Addr end;
+        bool prefetched;
+    };
+
+    /** Learned exit of a fetch block through a taken branch. */
+    struct FetchTargetEntry
+    {
+        bool valid = false;
+        Addr block = 0;
+        Addr branchPC = 0;
+        Addr target = 0;
+    };
+
+    /** Maximum number of entries in each thread's FTQ; 0 disables the
+     * decoupled frontend.
+     */
+    unsigned ftqSize;
+
+    /** Number of FTQ entries ahead of fetch whose lines are prefetched. */
+    unsigned fdipDistance;
+
+    /** Fetch target queue. Runs ahead of fetch so that I-cache misses on
+     * upcoming blocks can be prefetched while fetch is stalled.
+     */
+    std::deque<FetchTarget> ftq[MaxThreads];
+
+    /** Start address of the next block to append to the FTQ. */
+    Addr ftqNextPC[MaxThreads];
+
+    /** Whether ftqNextPC holds a valid address. */
+    bool ftqActive[MaxThreads];
+
+    /** Direct-mapped table of taken branch exits per fetch block, used
+     * to predict the successor of each FTQ entry.
+     */
+    std::vector<FetchTargetEntry> fetchTargetTable;
+
+    /** The last instruction fetch translation, used to translate the
+     * prefetches of FTQ entries that fall in the same page.
+     */
+    Addr ftqXlateVaddr[MaxThreads];
+    Addr ftqXlatePaddr[MaxThreads];
+    bool ftqXlateValid[MaxThreads];
+
+    /** The last line prefetched for each thread. */
+    Addr lastPrefetchLine[MaxThreads];
+
   protected:
     struct FetchStatGroup : public statistics::Group
     {
@@ -574,6 +647,12 @@ class Fetch
          * due to a squash.
          */
         statistics::Scalar tlbSquashes;
+        /** Number of I-cache prefetches issued for FTQ entries. */
+        statistics::Scalar ftqPrefetches;
+        /** Number of FTQ prefetches dropped for lack of a translation. */
+        statistics::Scalar ftqPrefetchesUntranslated;
+        /** Number of times fetch left the path held in the FTQ. */
+        statistics::Scalar ftqResyncs;
         /** Distribution of number of instructions fetched each cycle. */
         statistics::Distribution nisnDist;
         /** Rate of how often fetch was idle. */
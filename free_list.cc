@@ -40,7 +40,8 @@ namespace o3
 
 UnifiedFreeList::UnifiedFreeList(const std::string &_my_name,
                                  PhysRegFile *_regFile)
-    : _name(_my_name), regFile(_regFile)
+    : _name(_my_name), sharers(_regFile->totalNumPhysRegs(), 0),
+      regFile(_regFile)
 {
     DPRINTF(FreeList, "Creating new free list object.\n");
 
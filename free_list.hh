@@ -46,6 +46,7 @@
 #include <array>
 #include <iostream>
 #include <queue>
+#include <vector>
 
 #include "base/logging.hh"
 #include "base/trace.hh"
@@ -131,6 +132,14 @@ class UnifiedFreeList
 
     std::array<SimpleFreeList, CCRegClass + 1> freeLists;
 
+    /**
+     * Number of additional rename map entries sharing each physical
+     * register, indexed by flat index. A register is only put back on
+     * its free list once its last mapping has been released. Only
+     * eliminated moves and zero idioms create shared mappings.
+     */
+    std::vector<unsigned> sharers;
+
     /**
      * The register file object is used only to distinguish integer
      * from floating-point physical register indices.
@@ -173,9 +182,28 @@ class UnifiedFreeList
     void
     addReg(PhysRegIdPtr freed_reg)
     {
+        unsigned &count = sharers[freed_reg->flatIndex()];
+        if (count > 0) {
+            --count;
+            return;
+        }
         freeLists[freed_reg->classValue()].addReg(freed_reg);
     }
 
+    /**
+     * Records an additional mapping to an already allocated register,
+     * so that the matching addReg() releases that mapping instead of
+     * freeing the register.
+     */
+    void addReference(PhysRegIdPtr reg) { ++sharers[reg->flatIndex()]; }
+
+    /** Returns the number of additional mappings sharing a register. */
+    unsigned
+    numReferences(PhysRegIdPtr reg) const
+    {
+        return sharers[reg->flatIndex()];
+    }
+
     /** Checks if there are any free registers of type type. */
     bool
     hasFreeRegs(RegClassType type) const
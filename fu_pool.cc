@@ -138,6 +138,7 @@ FUPool::FUPool(const Params &p)
             //  Add the appropriate number of copies of this FU to the list
             fu->name = (*i)->name() + "(0)";
             funcUnits.push_back(fu);
+            unitCopy.push_back(0);
 
             for (int c = 1; c < (*i)->number; ++c) {
                 std::ostringstream s;
@@ -147,6 +148,7 @@ FUPool::FUPool(const Params &p)
                 s << (*i)->name() << "(" << c << ")";
                 fu2->name = s.str();
                 funcUnits.push_back(fu2);
+                unitCopy.push_back(c);
             }
         }
     }
@@ -186,6 +188,38 @@ FUPool::getUnit(OpClass capability)
     return fu_idx;
 }
 
+int
+FUPool::getUnit(OpClass capability, int cluster, int num_clusters)
+{
+    if (!capabilityList[capability])
+        return NoCapableFU;
+
+    int fu_idx = fuPerCapList[capability].getFU();
+    int start_idx = fu_idx;
+    int other_idx = NoFreeFU;
+    bool has_own = false;
+
+    do {
+        if (unitCopy[fu_idx] % num_clusters == cluster) {
+            has_own = true;
+            if (!unitBusy[fu_idx]) {
+                unitBusy[fu_idx] = true;
+                return fu_idx;
+            }
+        } else if (other_idx == NoFreeFU && !unitBusy[fu_idx]) {
+            other_idx = fu_idx;
+        }
+        fu_idx = fuPerCapList[capability].getFU();
+    } while (fu_idx != start_idx);
+
+    if (has_own || other_idx == NoFreeFU)
+        return NoFreeFU;
+
+    unitBusy[other_idx] = true;
+
+    return other_idx;
+}
+
 void
 FUPool::freeUnitNextCycle(int fu_idx)
 {
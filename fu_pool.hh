@@ -128,6 +128,9 @@ class FUPool : public SimObject
     /** Number of FUs. */
     int numFU;
 
+    /** Copy number of each FU among the units of its description. */
+    std::vector<int> unitCopy;
+
     /** Functional units. */
     std::vector<FuncUnit *> funcUnits;
 
@@ -176,6 +179,19 @@ class FUPool : public SimObject
      */
     int getUnit(OpClass capability);
 
+    /**
+     * Gets a FU providing the requested capability for an IQ cluster.
+     * The copies of each FU are dealt out to the clusters in turn; if
+     * the cluster has none providing the capability, a free unit of
+     * another cluster is used.
+     *
+     * @param capability The capability requested.
+     * @param cluster The cluster issuing the instruction.
+     * @param num_clusters The number of IQ clusters.
+     * @return As getUnit(OpClass).
+     */
+    int getUnit(OpClass capability, int cluster, int num_clusters);
+
     /** Frees a FU at the end of this cycle. */
     void freeUnitNextCycle(int fu_idx);
 
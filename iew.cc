@@ -45,6 +45,7 @@
 
 #include "cpu/o3/iew.hh"
 
+#include <algorithm>
 #include <queue>
 
 #include "base/types.hh"
@@ -70,6 +71,8 @@ IEW::IEW(CPU *_cpu, const BaseO3CPUParams &params)
       cpu(_cpu),
       instQueue(_cpu, this, params),
       ldstQueue(_cpu, this, params),
+      mlpFetch(params.smtFetchPolicy == SMTFetchPolicy::MLP &&
+               params.numThreads > 1),
       fuPool(params.fuPool),
       commitToIEWDelay(params.commitToIEWDelay),
       renameToIEWDelay(params.renameToIEWDelay),
@@ -80,6 +83,8 @@ IEW::IEW(CPU *_cpu, const BaseO3CPUParams &params)
       wbCycle(0),
       wbWidth(params.wbWidth),
       numThreads(params.numThreads),
+      loadValuePred(params.loadValuePred),
+      mlpFlush(params.smtMLPFlush),
       iewStats(cpu)
 {
     if (dispatchWidth > MaxWidth)
@@ -108,11 +113,25 @@ IEW::IEW(CPU *_cpu, const BaseO3CPUParams &params)
     for (ThreadID tid = 0; tid < MaxThreads; tid++) {
         dispatchStatus[tid] = Running;
         fetchRedirect[tid] = false;
+        mlpFlushedLoad[tid] = 0;
     }
 
     updateLSQNextCycle = false;
 
-    skidBufferMax = (renameToIEWDelay + 1) * params.renameWidth;
+    skidBufferMax = (renameToIEWDelay + 1) *
+        (params.macroOpFusion ?
+         std::min<unsigned>(2 * params.renameWidth, MaxWidth) :
+         params.renameWidth);
+
+    if (loadValuePred) {
+        valuePred.init(name() + ".valuePred", params.LVPTableSize,
+                       params.LVPConfidenceThreshold);
+    }
+
+    if (mlpFetch) {
+        mlpPred.init(params.smtMLPTableSize, params.numROBEntries,
+                     params.smtMLPThreshold);
+    }
 }
 
 std::string
@@ -175,6 +194,38 @@ IEW::IEWStats::IEWStats(CPU *cpu)
     ADD_STAT(branchMispredicts, statistics::units::Count::get(),
              "Number of branch mispredicts detected at execute",
              predictedTakenIncorrect + predictedNotTakenIncorrect),
+    ADD_STAT(valuePredLookups, statistics::units::Count::get(),
+             "Number of loads that looked up the value predictor"),
+    ADD_STAT(valuePredicted, statistics::units::Count::get(),
+             "Number of loads whose dependents were woken with a predicted "
+             "value"),
+    ADD_STAT(valuePredCorrect, statistics::units::Count::get(),
+             "Number of predicted load values that were correct"),
+    ADD_STAT(valuePredIncorrect, statistics::units::Count::get(),
+             "Number of predicted load values that were wrong"),
+    ADD_STAT(memRenameCorrect, statistics::units::Count::get(),
+             "Number of memory renamed loads that read their store's data"),
+    ADD_STAT(memRenameIncorrect, statistics::units::Count::get(),
+             "Number of memory renamed loads squashed for not reading their "
+             "store's data"),
+    ADD_STAT(valuePredCoverage, statistics::units::Ratio::get(),
+             "Fraction of looked up loads whose value was predicted",
+             valuePredicted / valuePredLookups),
+    ADD_STAT(valuePredAccuracy, statistics::units::Ratio::get(),
+             "Fraction of verified load value predictions that were correct",
+             valuePredCorrect / (valuePredCorrect + valuePredIncorrect)),
+    ADD_STAT(mlpStallCycles, statistics::units::Cycle::get(),
+             "Number of thread cycles fetch was gated on the MLP distance "
+             "of an outstanding miss"),
+    ADD_STAT(mlpFlushes, statistics::units::Count::get(),
+             "Number of squashes past the MLP distance of an outstanding "
+             "miss"),
+    ADD_STAT(regWritePortConflicts, statistics::units::Count::get(),
+             "Number of writebacks delayed for lack of a register file "
+             "write port"),
+    ADD_STAT(regWritePortStallCycles, statistics::units::Cycle::get(),
+             "Number of cycles a register file write port conflict delayed "
+             "writeback"),
     executedInstStats(cpu),
     ADD_STAT(instsToCommit, statistics::units::Count::get(),
              "Cumulative count of insts sent to commit"),
@@ -462,6 +513,252 @@ IEW::squashDueToMemOrder(const DynInstPtr& inst, ThreadID tid)
     }
 }
 
+void
+IEW::squashDueToValueMispredict(const DynInstPtr& inst, ThreadID tid)
+{
+    DPRINTF(IEW, "[tid:%i] Load value mispredict, squashing insts younger "
+            "than PC: %s [sn:%llu].\n", tid, inst->pcState(), inst->seqNum);
+
+    if (!toCommit->squash[tid] ||
+            inst->seqNum < toCommit->squashedSeqNum[tid]) {
+        toCommit->squash[tid] = true;
+        toCommit->squashedSeqNum[tid] = inst->seqNum;
+        toCommit->branchTaken[tid] = false;
+
+        set(toCommit->pc[tid], inst->pcState());
+        inst->staticInst->advancePC(*toCommit->pc[tid]);
+
+        toCommit->mispredictInst[tid] = NULL;
+        toCommit->includeSquashInst[tid] = false;
+
+        wroteToTimeBuffer = true;
+    }
+}
+
+void
+IEW::squashDueToMLP(const DynInstPtr& inst, ThreadID tid)
+{
+    DPRINTF(IEW, "[tid:%i] Fetched past the MLP distance, squashing insts "
+            "younger than PC: %s [sn:%llu].\n", tid, inst->pcState(),
+            inst->seqNum);
+
+    if (!toCommit->squash[tid] ||
+            inst->seqNum < toCommit->squashedSeqNum[tid]) {
+        toCommit->squash[tid] = true;
+        toCommit->squashedSeqNum[tid] = inst->seqNum;
+        toCommit->branchTaken[tid] = inst->readPredTaken();
+
+        // Refetch down the path the boundary instruction was predicted on.
+        set(toCommit->pc[tid], inst->readPredTarg());
+
+        toCommit->mispredictInst[tid] = NULL;
+        toCommit->includeSquashInst[tid] = false;
+
+        wroteToTimeBuffer = true;
+    }
+}
+
+void
+IEW::updateMLPFetch(ThreadID tid)
+{
+    toFetch->iewInfo[tid].mlpStall = false;
+
+    DynInstPtr load = ldstQueue.oldestLongLatencyLoad(
+            tid, mlpPred.longLatency());
+    if (!load)
+        return;
+
+    unsigned distance = mlpPred.predict(load->pcState().instAddr());
+
+    // Count what the thread has in flight past the load, remembering the
+    // instruction at the distance boundary in case of a flush.
+    std::vector<DynInstPtr> younger;
+    for (auto it = cpu->instList.rbegin(); it != cpu->instList.rend(); ++it) {
+        const DynInstPtr &inst = *it;
+        if (inst->seqNum <= load->seqNum)
+            break;
+        if (inst->threadNumber == tid && !inst->isSquashed())
+            younger.push_back(inst);
+    }
+
+    if (younger.size() < distance)
+        return;
+
+    toFetch->iewInfo[tid].mlpStall = true;
+    wroteToTimeBuffer = true;
+    ++iewStats.mlpStallCycles;
+
+    if (!mlpFlush || younger.size() == distance ||
+        mlpFlushedLoad[tid] == load->seqNum) {
+        return;
+    }
+
+    // younger is youngest first; the boundary keeps distance instructions
+    // past the load. It has to be in the ROB for commit to squash after it.
+    const DynInstPtr &boundary = distance ?
+        younger[younger.size() - distance] : load;
+    if (!boundary->isInROB())
+        return;
+
+    DPRINTF(IEW, "[tid:%i] Load [sn:%llu] PC %s has MLP distance %u with "
+            "%u insts in flight past it.\n", tid, load->seqNum,
+            load->pcState(), distance, younger.size());
+
+    mlpFlushedLoad[tid] = load->seqNum;
+    ++iewStats.mlpFlushes;
+    squashDueToMLP(boundary, tid);
+}
+
+void
+IEW::squashDueToLoadReplay(const DynInstPtr& inst)
+{
+    ThreadID tid = inst->threadNumber;
+
+    DPRINTF(IEW, "[tid:%i] Load missed after waking its dependents, "
+            "squashing insts younger than PC: %s [sn:%llu].\n",
+            tid, inst->pcState(), inst->seqNum);
+
+    // The load keeps executing; only what follows it is refetched.
+    if (!fetchRedirect[tid] ||
+        !toCommit->squash[tid] ||
+        toCommit->squashedSeqNum[tid] > inst->seqNum) {
+        fetchRedirect[tid] = true;
+
+        toCommit->squash[tid] = true;
+        toCommit->squashedSeqNum[tid] = inst->seqNum;
+        toCommit->branchTaken[tid] = false;
+
+        set(toCommit->pc[tid], inst->pcState());
+        inst->staticInst->advancePC(*toCommit->pc[tid]);
+
+        toCommit->mispredictInst[tid] = NULL;
+        toCommit->includeSquashInst[tid] = false;
+
+        wroteToTimeBuffer = true;
+    }
+}
+
+void
+IEW::predictLoadValue(const DynInstPtr &inst)
+{
+    if (inst->numDestRegs() != 1 || inst->isAtomic() ||
+        inst->isMicroop() || inst->isFusedTail() || inst->isMemRenamed() ||
+        inst->isNonSpeculative() || inst->isSerializing()) {
+        return;
+    }
+
+    PhysRegIdPtr dest_reg = inst->renamedDestIdx(0);
+    if (!dest_reg->is(IntRegClass) || dest_reg->isFixedMapping() ||
+        dest_reg->getNumPinnedWrites() != 0) {
+        return;
+    }
+
+    ++iewStats.valuePredLookups;
+
+    RegVal value;
+    inst->valuePredLookup(true);
+    if (!valuePred.predict(inst->pcState().instAddr(), value)) {
+        return;
+    }
+
+    DPRINTF(IEW, "[tid:%i] [sn:%llu] Predicted value %#x for load PC %s, "
+            "waking dependents.\n", inst->threadNumber, inst->seqNum,
+            value, inst->pcState());
+
+    inst->predictedValue = value;
+    inst->setValuePredicted();
+
+    cpu->setReg(dest_reg, value, inst->threadNumber);
+    scoreboard->setReg(dest_reg);
+    instQueue.wakeRegDependents(inst);
+
+    ++iewStats.valuePredicted;
+}
+
+void
+IEW::verifyValuePrediction(const DynInstPtr &inst)
+{
+    if (!inst->hasValuePredLookup()) {
+        return;
+    }
+
+    inst->valuePredLookup(false);
+
+    ThreadID tid = inst->threadNumber;
+    RegVal value = cpu->getReg(inst->renamedDestIdx(0), tid);
+    bool mispredicted = inst->isValuePredicted() &&
+        value != inst->predictedValue;
+
+    valuePred.update(inst->pcState().instAddr(), value, mispredicted);
+
+    if (!inst->isValuePredicted()) {
+        return;
+    }
+
+    if (!mispredicted) {
+        ++iewStats.valuePredCorrect;
+        return;
+    }
+
+    ++iewStats.valuePredIncorrect;
+
+    DPRINTF(IEW, "[tid:%i] [sn:%llu] Load PC %s value mispredicted, "
+            "predicted %#x actual %#x.\n", tid, inst->seqNum,
+            inst->pcState(), inst->predictedValue, value);
+
+    if (!fetchRedirect[tid] ||
+        !toCommit->squash[tid] ||
+        toCommit->squashedSeqNum[tid] > inst->seqNum) {
+        fetchRedirect[tid] = true;
+        squashDueToValueMispredict(inst, tid);
+    }
+}
+
+void
+IEW::verifyMemRename(const DynInstPtr &inst)
+{
+    if (!inst->isMemRenamed()) {
+        return;
+    }
+
+    ThreadID tid = inst->threadNumber;
+    PhysRegIdPtr data_reg = inst->renamedDestIdx(0);
+
+    // The store's data must be available to tell whether the load read
+    // it. If the load completed first it did not get its value from the
+    // store, so treat that as a misprediction as well.
+    if (scoreboard->getReg(data_reg) &&
+        cpu->getReg(data_reg, tid) == inst->loadedValue) {
+        ++iewStats.memRenameCorrect;
+        return;
+    }
+
+    ++iewStats.memRenameIncorrect;
+    ldstQueue.memRenamePred.mispredict(inst->pcState().instAddr());
+
+    DPRINTF(IEW, "[tid:%i] [sn:%llu] Memory renamed load PC %s did not "
+            "read its store's data, squashing it.\n", tid, inst->seqNum,
+            inst->pcState());
+
+    // The load's destination is the store's register, so the load itself
+    // has to be squashed and renamed again.
+    if (!fetchRedirect[tid] ||
+        !toCommit->squash[tid] ||
+        toCommit->squashedSeqNum[tid] >= inst->seqNum) {
+        fetchRedirect[tid] = true;
+        squashDueToMemOrder(inst, tid);
+    }
+}
+
+void
+IEW::releaseValuePrediction(const DynInstPtr &inst)
+{
+    if (inst->hasValuePredLookup()) {
+        inst->valuePredLookup(false);
+        valuePred.release(inst->pcState().instAddr());
+    }
+}
+
 void
 IEW::block(ThreadID tid)
 {
@@ -885,7 +1182,7 @@ IEW::dispatchInsts(ThreadID tid)
             insts_to_dispatch.pop();
 
             //Tell Rename That An Instruction has been processed
-            if (inst->isLoad()) {
+            if (inst->isLoad() && !inst->isRunahead()) {
                 toRename->iewInfo[tid].dispatchedToLQ++;
             }
             if (inst->isStore() || inst->isAtomic()) {
@@ -897,8 +1194,11 @@ IEW::dispatchInsts(ThreadID tid)
             continue;
         }
 
-        // Check for full conditions.
-        if (instQueue.isFull(tid)) {
+        // Check for full conditions. A fused tail shares its head's IQ
+        // entry and an eliminated move never enters the IQ, so neither
+        // needs a free one.
+        if (!inst->isFusedTail() && !inst->isEliminated() &&
+            instQueue.isFull(tid)) {
             DPRINTF(IEW, "[tid:%i] Issue: IQ has become full.\n", tid);
 
             // Call function to start blocking.
@@ -915,7 +1215,8 @@ IEW::dispatchInsts(ThreadID tid)
 
         // Check LSQ if inst is LD/ST
         if ((inst->isAtomic() && ldstQueue.sqFull(tid)) ||
-            (inst->isLoad() && ldstQueue.lqFull(tid)) ||
+            (inst->isLoad() && !inst->isRunahead() &&
+             ldstQueue.lqFull(tid)) ||
             (inst->isStore() && ldstQueue.sqFull(tid))) {
             DPRINTF(IEW, "[tid:%i] Issue: %s has become full.\n",tid,
                     inst->isLoad() ? "LQ" : "SQ");
@@ -965,6 +1266,15 @@ IEW::dispatchInsts(ThreadID tid)
             ++iewStats.dispNonSpecInsts;
 
             toRename->iewInfo[tid].dispatchedToSQ++;
+        } else if (inst->isLoad() && inst->isRunahead()) {
+            DPRINTF(IEW, "[tid:%i] Issue: Runahead load encountered, "
+                    "adding to IQ only.\n", tid);
+
+            // Precise Runahead loads only prefetch, so they take no LQ
+            // entry and are never checked for ordering violations.
+            ++iewStats.dispLoadInsts;
+
+            add_to_iq = true;
         } else if (inst->isLoad()) {
             DPRINTF(IEW, "[tid:%i] Issue: Memory instruction "
                     "encountered, adding to LSQ.\n", tid);
@@ -1005,6 +1315,19 @@ IEW::dispatchInsts(ThreadID tid)
             // Same as non-speculative stores.
             inst->setCanCommit();
             instQueue.insertBarrier(inst);
+            add_to_iq = false;
+        } else if (inst->isEliminated()) {
+            DPRINTF(IEW, "[tid:%i] Issue: Eliminated move or zero idiom "
+                    "encountered, skipping.\n", tid);
+
+            // Rename already mapped the destination onto a live physical
+            // register, so there is nothing left to execute. Do not record
+            // it as the producer of that register either; the original
+            // producer (if any) is still the one that wakes dependents.
+            inst->setIssued();
+            inst->setExecuted();
+            inst->setCanCommit();
+
             add_to_iq = false;
         } else if (inst->isNop()) {
             DPRINTF(IEW, "[tid:%i] Issue: Nop instruction encountered, "
@@ -1043,6 +1366,10 @@ IEW::dispatchInsts(ThreadID tid)
         // instruction.
         if (add_to_iq) {
             instQueue.insert(inst);
+
+            if (loadValuePred && inst->isLoad() && !inst->isRunahead()) {
+                predictLoadValue(inst);
+            }
         }
 
         insts_to_dispatch.pop();
@@ -1148,6 +1475,12 @@ IEW::executeInsts()
             continue;
         }
 
+        // An instruction woken assuming its load hit reads its operands
+        // here; it goes back to the IQ if the load's data is not back.
+        if (instQueue.replayIfLoadMissed(inst)) {
+            continue;
+        }
+
         Fault fault = NoFault;
 
         // Execute instruction.
@@ -1171,6 +1504,11 @@ IEW::executeInsts()
                     instQueue.deferMemInst(inst);
                     continue;
                 }
+            } else if (inst->isLoad() && inst->isRunahead()) {
+                // Runahead loads translate functionally and either prefetch
+                // or complete right away with a stale value; they never
+                // fault or defer.
+                fault = inst->initiateAcc();
             } else if (inst->isLoad()) {
                 // Loads will mark themselves as executed, and their writeback
                 // event adds the instruction to the queue to commit
@@ -1341,9 +1679,65 @@ IEW::executeInsts()
 
 }
 
+void
+IEW::arbitrateWritePorts()
+{
+    int kept = 0;
+    int num_insts = 0;
+    bool write_port_stall = false;
+
+    for (; num_insts < wbWidth && toCommit->insts[num_insts]; num_insts++) {
+        DynInstPtr inst = toCommit->insts[num_insts];
+
+        // Only instructions that write back results need a port.
+        if (inst->isSquashed() || !inst->isExecuted() ||
+            inst->getFault() != NoFault || inst->isMemRenamed() ||
+            cpu->regFile.writePorts(inst, cpu->curCycle(), true)) {
+            toCommit->insts[kept++] = inst;
+            continue;
+        }
+
+        // Take the first free writeback slot of a later cycle, as
+        // instToCommit() does, within the cycles the queue holds.
+        int cycle = 1;
+        int slot = 0;
+        while (iewQueue->valid(cycle) && (*iewQueue)[cycle].insts[slot]) {
+            if (++slot == wbWidth) {
+                ++cycle;
+                slot = 0;
+            }
+        }
+
+        ++iewStats.regWritePortConflicts;
+        write_port_stall = true;
+
+        if (!iewQueue->valid(cycle)) {
+            // No later slot is free; write back now rather than lose it.
+            toCommit->insts[kept++] = inst;
+            continue;
+        }
+
+        DPRINTF(IEW, "[tid:%i] [sn:%llu] No register file write port, "
+                "delaying writeback.\n", inst->threadNumber, inst->seqNum);
+
+        (*iewQueue)[cycle].insts[slot] = inst;
+        (*iewQueue)[cycle].size++;
+    }
+
+    for (int i = kept; i < num_insts; i++)
+        toCommit->insts[i] = NULL;
+    toCommit->size -= num_insts - kept;
+
+    if (write_port_stall)
+        ++iewStats.regWritePortStallCycles;
+}
+
 void
 IEW::writebackInsts()
 {
+    if (cpu->regFile.banked())
+        arbitrateWritePorts();
+
     // Loop through the head of the time buffer and wake any
     // dependents.  These instructions are about to write back.  Also
     // mark scoreboard that this instruction is finally complete.
@@ -1389,7 +1783,8 @@ IEW::writebackInsts()
         }
         
         // 调用依赖链指令解码函数
-        cpu->taintScoreboard.decodeChainInstructionOperands(pc, inst);
+        if (cpu->dvrRunahead())
+            cpu->taintScoreboard.decodeChainInstructionOperands(pc, inst);
 
         iewStats.instsToCommit[tid]++;
         // Notify potential listeners that execution is complete for this
@@ -1405,7 +1800,8 @@ IEW::writebackInsts()
                 inst->getFault() == NoFault) {
             int dependents = instQueue.wakeDependents(inst);
 
-            for (int i = 0; i < inst->numDestRegs(); i++) {
+            for (int i = 0; i < inst->numDestRegs() &&
+                     !inst->isMemRenamed(); i++) {
                 // Mark register as ready if not pinned
                 if (inst->renamedDestIdx(i)->
                         getNumPinnedWritesToComplete() == 0) {
@@ -1537,6 +1933,10 @@ IEW::tick()
             wroteToTimeBuffer = true;
         }
 
+        if (mlpFetch) {
+            updateMLPFetch(tid);
+        }
+
         DPRINTF(IEW, "[tid:%i], Dispatch dispatched %i instructions.\n",
                 tid, toRename->iewInfo[tid].dispatched);
     }
@@ -50,7 +50,9 @@
 #include "cpu/o3/inst_queue.hh"
 #include "cpu/o3/limits.hh"
 #include "cpu/o3/lsq.hh"
+#include "cpu/o3/mlp_pred.hh"
 #include "cpu/o3/scoreboard.hh"
+#include "cpu/o3/value_pred.hh"
 #include "cpu/timebuf.hh"
 #include "debug/IEW.hh"
 #include "sim/probe/probe.hh"
@@ -238,6 +240,29 @@ class IEW
 
     bool getLoopBoundArrive();
 
+    /** Checks a completed load against its predicted value, training the
+     * value predictor and squashing everything younger than the load if
+     * dependents were woken with a wrong value.
+     */
+    void verifyValuePrediction(const DynInstPtr &inst);
+
+    /** Checks that a memory renamed load read the value held in the
+     * data register of the store it was renamed to, squashing the load
+     * and everything younger if it did not.
+     */
+    void verifyMemRename(const DynInstPtr &inst);
+
+    /** Squashes everything younger than a load whose speculatively woken
+     * dependents issued before its data returned, when the IQ replays by
+     * squashing from the load.
+     */
+    void squashDueToLoadReplay(const DynInstPtr &inst);
+
+    /** Drops the value predictor lookup of a load that will not complete,
+     * either because it was squashed or because it faulted.
+     */
+    void releaseValuePrediction(const DynInstPtr &inst);
+
   private:
     /** Sends commit proper information for a squash due to a branch
      * mispredict.
@@ -249,6 +274,28 @@ class IEW
      */
     void squashDueToMemOrder(const DynInstPtr &inst, ThreadID tid);
 
+    /** Sends commit proper information for a squash due to a load value
+     * misprediction. The load itself holds the right value by now, so
+     * only younger instructions are squashed.
+     */
+    void squashDueToValueMispredict(const DynInstPtr &inst, ThreadID tid);
+
+    /** Sends commit proper information for a squash of the instructions a
+     * thread fetched past the MLP distance of its outstanding miss.
+     */
+    void squashDueToMLP(const DynInstPtr &inst, ThreadID tid);
+
+    /** Tells fetch whether a thread has run as far past its oldest
+     * long-latency load as that load's predicted MLP distance, and
+     * flushes the instructions beyond it if flushing is enabled.
+     */
+    void updateMLPFetch(ThreadID tid);
+
+    /** Predicts the value of a load being dispatched and, if confident,
+     * writes it to the load's destination and wakes its dependents.
+     */
+    void predictLoadValue(const DynInstPtr &inst);
+
     /** Sets Dispatch to blocked, and signals back to other stages to block. */
     void block(ThreadID tid);
 
@@ -276,6 +323,11 @@ class IEW
      */
     void writebackInsts();
 
+    /** Gives the instructions writing back this cycle the register file
+     * write ports they need, moving those that find none to a later cycle.
+     */
+    void arbitrateWritePorts();
+
     /** Checks if any of the stall conditions are currently true. */
     bool checkStall(ThreadID tid);
 
@@ -362,6 +414,14 @@ class IEW
     /** Load / store queue. */
     LSQ ldstQueue;
 
+    /** MLP distance predictor for the MLP-aware fetch policy, trained by
+     * commit.
+     */
+    MLPPredictor mlpPred;
+
+    /** Whether the MLP-aware fetch policy is in use. */
+    bool mlpFetch;
+
     /** Pointer to the functional unit pool. */
     FUPool *fuPool;
     /** Records if the LSQ needs to be updated on the next cycle, so that
@@ -419,6 +479,18 @@ class IEW
     /** Maximum size of the skid buffer. */
     unsigned skidBufferMax;
 
+    /** Whether load values are predicted at dispatch. */
+    bool loadValuePred;
+
+    /** Load value predictor. */
+    LoadValuePredictor valuePred;
+
+    /** Whether threads are flushed past the MLP distance of a miss. */
+    bool mlpFlush;
+
+    /** Last long-latency load each thread was flushed behind. */
+    InstSeqNum mlpFlushedLoad[MaxThreads];
+
 
     struct IEWStats : public statistics::Group
     {
@@ -455,6 +527,36 @@ class IEW
         /** Stat for total number of mispredicted branches detected at
          *  execute. */
         statistics::Formula branchMispredicts;
+        /** Stat for number of loads that looked up the value predictor. */
+        statistics::Scalar valuePredLookups;
+        /** Stat for number of loads whose value was predicted. */
+        statistics::Scalar valuePredicted;
+        /** Stat for number of predicted load values that were correct. */
+        statistics::Scalar valuePredCorrect;
+        /** Stat for number of predicted load values that were wrong. */
+        statistics::Scalar valuePredIncorrect;
+        /** Stat for number of memory renamed loads that were correct. */
+        statistics::Scalar memRenameCorrect;
+        /** Stat for number of memory renamed loads that were wrong. */
+        statistics::Scalar memRenameIncorrect;
+        /** Fraction of looked up loads whose value was predicted. */
+        statistics::Formula valuePredCoverage;
+        /** Fraction of verified predictions that were correct. */
+        statistics::Formula valuePredAccuracy;
+        /** Stat for number of cycles a thread's fetch was gated on the
+         * MLP distance of its outstanding miss.
+         */
+        statistics::Scalar mlpStallCycles;
+        /** Stat for number of flushes past the MLP distance of a miss. */
+        statistics::Scalar mlpFlushes;
+        /** Stat for number of writebacks delayed for lack of a register
+         * file write port.
+         */
+        statistics::Scalar regWritePortConflicts;
+        /** Stat for number of cycles a write port conflict delayed a
+         * writeback.
+         */
+        statistics::Scalar regWritePortStallCycles;
 
         struct ExecutedInstStats : public statistics::Group
         {
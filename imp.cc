@@ -0,0 +1,198 @@
+#include "cpu/o3/imp.hh"
+
+#include <algorithm>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst.hh"
+#include "cpu/o3/lane_value.hh"
+#include "cpu/o3/lsq.hh"
+#include "debug/IMP.hh"
+#include "params/BaseO3CPU.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+IndirectMemPrefetcher::IndirectMemPrefetcher(CPU *_cpu,
+                                             const BaseO3CPUParams &params)
+    : stats(_cpu),
+      cpu(_cpu),
+      _enabled(params.runaheadEngine == RunaheadEngine::IMP),
+      distance(params.impDistance),
+      table(params.impTableSize),
+      indexMask(params.impTableSize - 1)
+{
+    if (!isPowerOf2(params.impTableSize)) {
+        fatal("Invalid IMP table size!\n");
+    }
+}
+
+IndirectMemPrefetcher::Entry *
+IndirectMemPrefetcher::lookup(Addr pc, ThreadID tid)
+{
+    Entry &entry = table[calcIndex(pc)];
+    if (!entry.valid || entry.pc != pc || entry.tid != tid)
+        return nullptr;
+    return &entry;
+}
+
+void
+IndirectMemPrefetcher::observeLoad(const DynInstPtr &inst, Addr addr,
+                                   int stride)
+{
+    Addr pc = inst->pcState().instAddr();
+    ThreadID tid = inst->threadNumber;
+
+    if (stride != 0) {
+        Entry &entry = table[calcIndex(pc)];
+        if (!entry.valid || entry.pc != pc || entry.tid != tid) {
+            entry = Entry();
+            entry.valid = true;
+            entry.pc = pc;
+            entry.tid = tid;
+        }
+        entry.stride = stride;
+
+        if (entry.hasPattern) {
+            prefetch(tid, addr + (Addr)distance * stride, inst->effSize, pc,
+                     true);
+        }
+        return;
+    }
+
+    for (auto &entry : table) {
+        if (entry.valid && entry.tid == tid && !entry.history.empty())
+            train(entry, pc, addr, inst->effSize);
+    }
+}
+
+void
+IndirectMemPrefetcher::train(Entry &entry, Addr pc, Addr addr,
+                             unsigned size)
+{
+    bool matched = false;
+
+    for (RegVal index : entry.history) {
+        for (unsigned shift = 0; shift < numShifts; shift++) {
+            Addr base = addr - (index << shift);
+
+            if (entry.hasPattern && pc == entry.targetPC &&
+                shift == entry.shift && base == entry.base) {
+                matched = true;
+            }
+
+            auto it = entry.candidates.find({pc, shift, base});
+            if (it == entry.candidates.end()) {
+                if (entry.candidates.size() >= maxCandidates)
+                    entry.candidates.clear();
+                entry.candidates[{pc, shift, base}].index = index;
+                continue;
+            }
+
+            Candidate &cand = it->second;
+            if (cand.index == index)
+                continue;
+            cand.index = index;
+
+            if (++cand.hits < hitThreshold || (entry.hasPattern &&
+                    pc == entry.targetPC && shift == entry.shift &&
+                    base == entry.base)) {
+                continue;
+            }
+
+            DPRINTF(IMP, "[tid:%i] Index load PC %#x: load PC %#x reads "
+                    "%#x + (index << %u)\n", entry.tid, entry.pc, pc, base,
+                    shift);
+
+            entry.hasPattern = true;
+            entry.targetPC = pc;
+            entry.targetSize = size;
+            entry.shift = shift;
+            entry.base = base;
+            entry.conf = maxConf;
+            entry.candidates.clear();
+            ++stats.patterns;
+            return;
+        }
+    }
+
+    if (entry.hasPattern && pc == entry.targetPC) {
+        if (matched) {
+            entry.conf = std::min<uint8_t>(entry.conf + 1, maxConf);
+        } else if (--entry.conf == 0) {
+            DPRINTF(IMP, "[tid:%i] Index load PC %#x lost its pattern\n",
+                    entry.tid, entry.pc);
+            entry.hasPattern = false;
+        }
+    }
+}
+
+void
+IndirectMemPrefetcher::loadCompleted(const DynInstPtr &inst)
+{
+    Entry *entry = lookup(inst->pcState().instAddr(), inst->threadNumber);
+    if (!entry || !inst->memData || inst->effSize > sizeof(RegVal))
+        return;
+
+    entry->history.push_back(readLaneValue(inst->memData, inst->effSize));
+    if (entry->history.size() > historySize)
+        entry->history.pop_front();
+}
+
+void
+IndirectMemPrefetcher::indexArrived(Addr index_pc, ThreadID tid,
+                                    PacketPtr pkt)
+{
+    Entry *entry = lookup(index_pc, tid);
+    if (!entry || !entry->hasPattern || pkt->getSize() > sizeof(RegVal))
+        return;
+
+    RegVal index = readLaneValue(pkt->getConstPtr<uint8_t>(),
+                                 pkt->getSize());
+    prefetch(tid, entry->base + (index << entry->shift), entry->targetSize,
+             entry->targetPC, false);
+}
+
+void
+IndirectMemPrefetcher::prefetch(ThreadID tid, Addr addr, unsigned size,
+                                Addr pc, bool index)
+{
+    if (!cpu->getLSQ().sendPrefetch(tid, addr, size, pc,
+            new IndirectPrefetchMarker(tid, pc, index))) {
+        ++stats.droppedLoads;
+        return;
+    }
+
+    DPRINTF(IMP, "[tid:%i] Prefetching %s %#x for PC %#x\n", tid,
+            index ? "index" : "indirect", addr, pc);
+
+    if (index)
+        ++stats.indexPrefetches;
+    else
+        ++stats.prefetches;
+}
+
+IndirectMemPrefetcher::IMPStats::IMPStats(statistics::Group *parent)
+    : statistics::Group(parent, "imp"),
+      ADD_STAT(patterns, statistics::units::Count::get(),
+               "Number of indirect access patterns learnt"),
+      ADD_STAT(indexPrefetches, statistics::units::Count::get(),
+               "Number of index prefetches sent ahead of index loads"),
+      ADD_STAT(prefetches, statistics::units::Count::get(),
+               "Number of indirect prefetches sent to the cache"),
+      ADD_STAT(droppedLoads, statistics::units::Count::get(),
+               "Number of prefetches that could not be sent")
+{
+    patterns.prereq(patterns);
+    indexPrefetches.prereq(indexPrefetches);
+    prefetches.prereq(prefetches);
+    droppedLoads.prereq(droppedLoads);
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,153 @@
+#ifndef __CPU_O3_IMP_HH__
+#define __CPU_O3_IMP_HH__
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/o3/dyn_inst_ptr.hh"
+#include "mem/packet.hh"
+
+namespace gem5
+{
+
+struct BaseO3CPUParams;
+
+namespace o3
+{
+
+class CPU;
+
+/**
+ * Indirect Memory Prefetcher, selected with runaheadEngine=IMP as the
+ * hardware baseline DVR is compared against. See "IMP: Indirect Memory
+ * Prefetcher" by Yu et al.
+ *
+ * Index loads are the stride loads found by the LSQ stride detector. The
+ * last few values each one returned are matched against the addresses of
+ * the loads that follow: a load whose address is base + (index << shift)
+ * for the same base and shift over different index values is an
+ * indirect access through that index stream. Once such a pattern is
+ * learnt, every execution of the index load prefetches the index a
+ * distance ahead, and when that prefetch returns, its value gives the
+ * address of the matching indirect access, which is prefetched in turn.
+ */
+class IndirectMemPrefetcher
+{
+  public:
+    IndirectMemPrefetcher(CPU *_cpu, const BaseO3CPUParams &params);
+
+    /** Whether IMP is the selected runahead engine. */
+    bool enabled() const { return _enabled; }
+
+    /**
+     * Trains on a load about to access memory. If it is the index load
+     * of a learnt pattern, the index a distance ahead is prefetched.
+     * @param addr The virtual address of the load.
+     * @param stride The stride of the load if it is a stride load, 0
+     * otherwise.
+     */
+    void observeLoad(const DynInstPtr &inst, Addr addr, int stride);
+
+    /** Records the value a load returned if it is a tracked index load. */
+    void loadCompleted(const DynInstPtr &inst);
+
+    /** Prefetches the indirect access an index prefetch leads to. */
+    void indexArrived(Addr index_pc, ThreadID tid, PacketPtr pkt);
+
+    struct IMPStats : public statistics::Group
+    {
+        IMPStats(statistics::Group *parent);
+
+        /** Stat for the number of indirect patterns learnt. */
+        statistics::Scalar patterns;
+        /** Stat for the number of index prefetches sent. */
+        statistics::Scalar indexPrefetches;
+        /** Stat for the number of indirect prefetches sent. */
+        statistics::Scalar prefetches;
+        /** Stat for the number of prefetches that could not be sent. */
+        statistics::Scalar droppedLoads;
+    } stats;
+
+  private:
+    /** Base candidates, keyed by load PC, shift and base. */
+    using CandidateKey = std::tuple<Addr, unsigned, Addr>;
+
+    struct Candidate
+    {
+        /** Index value the candidate last matched. */
+        RegVal index = 0;
+        /** Matches with a different index value since it was made. */
+        uint8_t hits = 0;
+    };
+
+    struct Entry
+    {
+        bool valid = false;
+        Addr pc = 0;
+        ThreadID tid = 0;
+        int stride = 0;
+
+        /** Recent values of the index load, newest last. */
+        std::deque<RegVal> history;
+
+        std::map<CandidateKey, Candidate> candidates;
+
+        /** The learnt pattern, if any. */
+        bool hasPattern = false;
+        Addr targetPC = 0;
+        unsigned targetSize = 0;
+        unsigned shift = 0;
+        Addr base = 0;
+        /** Confidence in the pattern; it is dropped at zero. */
+        uint8_t conf = 0;
+    };
+
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr pc) const { return (pc >> 1) & indexMask; }
+
+    /** Returns the entry of an index load, or nullptr. */
+    Entry *lookup(Addr pc, ThreadID tid);
+
+    /** Matches a load against the recent values of an index load. */
+    void train(Entry &entry, Addr pc, Addr addr, unsigned size);
+
+    /** Sends a prefetch through the LSQ, counting it. */
+    void prefetch(ThreadID tid, Addr addr, unsigned size, Addr pc,
+                  bool index);
+
+    CPU *cpu;
+
+    bool _enabled;
+
+    /** How many index elements ahead prefetches are made. */
+    unsigned distance;
+
+    std::vector<Entry> table;
+
+    unsigned indexMask;
+
+    /** Index values kept per index load. */
+    static constexpr unsigned historySize = 4;
+
+    /** Shifts tried, that is element sizes of 1 to 8 bytes. */
+    static constexpr unsigned numShifts = 4;
+
+    /** Candidates kept per index load before they are cleared. */
+    static constexpr unsigned maxCandidates = 1024;
+
+    /** Matches a candidate needs to become the pattern. */
+    static constexpr uint8_t hitThreshold = 2;
+
+    /** Saturation value of the pattern confidence. */
+    static constexpr uint8_t maxConf = 3;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_IMP_HH__
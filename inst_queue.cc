@@ -41,9 +41,11 @@
 
 #include "cpu/o3/inst_queue.hh"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/fu_pool.hh"
@@ -93,6 +95,14 @@ InstructionQueue::InstructionQueue(CPU *cpu_ptr, IEW *iew_ptr,
       numThreads(params.numThreads),
       numEntries(params.numIQEntries),
       totalWidth(params.issueWidth),
+      specLoadWakeup(params.speculativeLoadWakeup),
+      loadHitLatency(params.loadHitLatency),
+      replayPolicy(params.loadReplayPolicy),
+      issuePolicy(params.issuePolicy),
+      numClusters(params.numIQClusters),
+      steeringPolicy(params.iqSteeringPolicy),
+      clusterBypassLatency(params.iqClusterBypassLatency),
+      dvrCluster(params.iqDVRCluster),
       commitToIEWDelay(params.commitToIEWDelay),
       iqStats(cpu, totalWidth),
       iqIOStats(cpu)
@@ -117,6 +127,26 @@ InstructionQueue::InstructionQueue(CPU *cpu_ptr, IEW *iew_ptr,
 
     // Resize the register scoreboard.
     regScoreboard.resize(numPhysRegs);
+    specReadyRegs.resize(numPhysRegs);
+
+    if (issuePolicy == IssuePolicy::CriticalFirst) {
+        critPred.init(name() + ".critPred", params.criticalityTableSize);
+    }
+
+    fatal_if(numClusters == 0 || numClusters > numEntries,
+             "numIQClusters must be between 1 and the number of IQ "
+             "entries.\n");
+    fatal_if(dvrCluster && numClusters < 2,
+             "iqDVRCluster needs at least two IQ clusters.\n");
+
+    clusterEntries = divCeil(numEntries, numClusters);
+    clusterCount.resize(numClusters);
+    regCluster.resize(numPhysRegs);
+
+    iqStats.clusterInsts.init(numClusters);
+    iqStats.clusterImbalance
+        .init(0, clusterEntries, 1)
+        .flags(statistics::pdf);
 
     //Initialize Mem Dependence Units
     for (ThreadID tid = 0; tid < MaxThreads; tid++) {
@@ -127,8 +157,10 @@ InstructionQueue::InstructionQueue(CPU *cpu_ptr, IEW *iew_ptr,
     resetState();
 
     //Figure out resource sharing policy
-    if (iqPolicy == SMTQueuePolicy::Dynamic) {
-        //Set Max Entries to Total ROB Capacity
+    if (iqPolicy == SMTQueuePolicy::Dynamic ||
+        iqPolicy == SMTQueuePolicy::Adaptive) {
+        //Set Max Entries to Total IQ Capacity; Adaptive shares are
+        //enforced at rename
         for (ThreadID tid = 0; tid < numThreads; tid++) {
             maxEntries[tid] = numEntries;
         }
@@ -217,7 +249,49 @@ InstructionQueue::IQStats::IQStats(CPU *cpu, const unsigned &total_width)
     ADD_STAT(fuBusy, statistics::units::Count::get(), "FU busy when requested"),
     ADD_STAT(fuBusyRate, statistics::units::Rate<
                 statistics::units::Count, statistics::units::Count>::get(),
-             "FU busy rate (busy events/executed inst)")
+             "FU busy rate (busy events/executed inst)"),
+    ADD_STAT(specWakeupLoads, statistics::units::Count::get(),
+             "Number of loads that woke dependents before their data "
+             "returned"),
+    ADD_STAT(specWokenInsts, statistics::units::Count::get(),
+             "Number of instructions woken speculatively by loads"),
+    ADD_STAT(replayedInsts, statistics::units::Count::get(),
+             "Number of issued instructions replayed because their load "
+             "missed"),
+    ADD_STAT(replaySquashes, statistics::units::Count::get(),
+             "Number of squashes from a load due to replay"),
+    ADD_STAT(replayRate, statistics::units::Rate<
+                statistics::units::Count, statistics::units::Count>::get(),
+             "Replayed instructions per issued instruction",
+             replayedInsts / instsIssued),
+    ADD_STAT(criticalInsts, statistics::units::Count::get(),
+             "Number of instructions added to the IQ marked critical"),
+    ADD_STAT(criticalBypasses, statistics::units::Count::get(),
+             "Number of critical instructions issued ahead of an older "
+             "ready instruction"),
+    ADD_STAT(critTrainHeadStalls, statistics::units::Count::get(),
+             "Number of instructions trained critical for stalling commit"),
+    ADD_STAT(critTrainFanouts, statistics::units::Count::get(),
+             "Number of instructions trained critical for their fan-out"),
+    ADD_STAT(regReadPortConflicts, statistics::units::Count::get(),
+             "Number of times a ready instruction could not issue for lack "
+             "of a register file read port"),
+    ADD_STAT(regReadPortStallCycles, statistics::units::Cycle::get(),
+             "Number of cycles a register file read port conflict held back "
+             "issue"),
+    ADD_STAT(clusterInsts, statistics::units::Count::get(),
+             "Number of instructions steered to each IQ cluster"),
+    ADD_STAT(steeringOverflows, statistics::units::Count::get(),
+             "Number of instructions steered away from a full cluster"),
+    ADD_STAT(clusterImbalance, statistics::units::Count::get(),
+             "Difference in occupancy between the most and least occupied "
+             "clusters, per cycle"),
+    ADD_STAT(crossClusterWakeups, statistics::units::Count::get(),
+             "Number of instructions woken by a producer in another "
+             "cluster"),
+    ADD_STAT(clusterBypassStalls, statistics::units::Count::get(),
+             "Number of ready instructions held back for an operand on the "
+             "inter-cluster bypass")
 {
     instsAdded
         .prereq(instsAdded);
@@ -254,6 +328,51 @@ InstructionQueue::IQStats::IQStats(CPU *cpu, const unsigned &total_width)
 
     squashedNonSpecRemoved
         .prereq(squashedNonSpecRemoved);
+
+    specWakeupLoads
+        .prereq(specWakeupLoads);
+
+    specWokenInsts
+        .prereq(specWokenInsts);
+
+    replayedInsts
+        .prereq(replayedInsts);
+
+    replaySquashes
+        .prereq(replaySquashes);
+
+    criticalInsts
+        .prereq(criticalInsts);
+
+    criticalBypasses
+        .prereq(criticalBypasses);
+
+    critTrainHeadStalls
+        .prereq(critTrainHeadStalls);
+
+    critTrainFanouts
+        .prereq(critTrainFanouts);
+
+    regReadPortConflicts
+        .prereq(regReadPortConflicts);
+
+    regReadPortStallCycles
+        .prereq(regReadPortStallCycles);
+
+    clusterInsts
+        .prereq(clusterInsts);
+
+    steeringOverflows
+        .prereq(steeringOverflows);
+
+    clusterImbalance
+        .prereq(clusterImbalance);
+
+    crossClusterWakeups
+        .prereq(crossClusterWakeups);
+
+    clusterBypassStalls
+        .prereq(clusterBypassStalls);
 /*
     queueResDist
         .init(Num_OpClasses, 0, 99, 2)
@@ -401,6 +520,7 @@ InstructionQueue::resetState()
 
     // Initialize the number of free IQ entries.
     freeEntries = numEntries;
+    std::fill(clusterCount.begin(), clusterCount.end(), 0);
 
     // Note that in actuality, the registers corresponding to the logical
     // registers start off as ready.  However this doesn't matter for the
@@ -409,12 +529,17 @@ InstructionQueue::resetState()
     // unready.
     for (int i = 0; i < numPhysRegs; ++i) {
         regScoreboard[i] = false;
+        specReadyRegs[i] = false;
     }
 
     for (ThreadID tid = 0; tid < MaxThreads; ++tid) {
         squashedSeqNum[tid] = 0;
     }
 
+    pendingSpecWakeups.clear();
+    specWokenLoads.clear();
+    bypassInsts.clear();
+
     for (int i = 0; i < Num_OpClasses; ++i) {
         while (!readyInsts[i].empty())
             readyInsts[i].pop();
@@ -454,6 +579,7 @@ InstructionQueue::isDrained() const
 {
     bool drained = dependGraph.empty() &&
                    instsToExecute.empty() &&
+                   bypassInsts.empty() &&
                    wbOutstanding == 0;
     for (ThreadID tid = 0; tid < numThreads; ++tid)
         drained = drained && memDepUnit[tid].isDrained();
@@ -518,6 +644,15 @@ InstructionQueue::numFreeEntries()
 unsigned
 InstructionQueue::numFreeEntries(ThreadID tid)
 {
+    // Rename takes off the entries held back for other threads. Shares
+    // move between epochs, so a thread whose share grew may still have to
+    // wait for another to drain its old one.
+    if (iqPolicy == SMTQueuePolicy::Adaptive) {
+        return std::min<unsigned>(maxEntries[tid] - count[tid],
+                freeEntries + cpu->smtPartitioner.reservedEntries(
+                        SMTPartitioner::IQRes, tid));
+    }
+
     return maxEntries[tid] - count[tid];
 }
 
@@ -575,14 +710,26 @@ InstructionQueue::insert(const DynInstPtr &new_inst)
     DPRINTF(IQ, "Adding instruction [sn:%llu] PC %s to the IQ.\n",
             new_inst->seqNum, new_inst->pcState());
 
-    assert(freeEntries != 0);
+    // A fused tail shares the IQ entry of its head.
+    bool takes_entry = !new_inst->isFusedTail();
+
+    assert(freeEntries != 0 || !takes_entry);
+
+    steer(new_inst);
 
     instList[new_inst->threadNumber].push_back(new_inst);
 
-    --freeEntries;
+    if (takes_entry)
+        --freeEntries;
 
     new_inst->setInIQ();
 
+    // Criticality orders the ready lists, so it must be settled before
+    // the instruction can be put on one.
+    if (issuePolicy == IssuePolicy::CriticalFirst) {
+        markIfCritical(new_inst);
+    }
+
     // Look through its source registers (physical regs), and mark any
     // dependencies.
     addToDependents(new_inst);
@@ -599,7 +746,8 @@ InstructionQueue::insert(const DynInstPtr &new_inst)
 
     ++iqStats.instsAdded;
 
-    count[new_inst->threadNumber]++;
+    if (takes_entry)
+        count[new_inst->threadNumber]++;
 
     assert(freeEntries == (numEntries - countInsts()));
 }
@@ -627,6 +775,8 @@ InstructionQueue::insertNonSpec(const DynInstPtr &new_inst)
 
     assert(freeEntries != 0);
 
+    steer(new_inst);
+
     instList[new_inst->threadNumber].push_back(new_inst);
 
     --freeEntries;
@@ -766,6 +916,14 @@ InstructionQueue::scheduleReadyInsts()
         addReadyMemInst(mem_inst);
     }
 
+    if (specLoadWakeup) {
+        wakeSpecLoadDependents();
+    }
+
+    if (!bypassInsts.empty()) {
+        drainBypass();
+    }
+
     // Have iterator to head of the list
     // While I haven't exceeded bandwidth or reached the end of the list,
     // Try to get a FU that can do what this op needs.
@@ -775,6 +933,7 @@ InstructionQueue::scheduleReadyInsts()
     // This will avoid trying to schedule a certain op class if there are no
     // FUs that handle it.
     int total_issued = 0;
+    bool read_port_stall = false;
     ListOrderIt order_it = listOrder.begin();
     ListOrderIt order_end_it = listOrder.end();
 
@@ -812,12 +971,25 @@ InstructionQueue::scheduleReadyInsts()
             continue;
         }
 
+        // Operands are read from the register file banks at issue; an
+        // instruction whose banks are out of read ports waits a cycle.
+        if (cpu->regFile.banked() &&
+            !cpu->regFile.readPorts(issuing_inst, cpu->curCycle(), false)) {
+            ++iqStats.regReadPortConflicts;
+            read_port_stall = true;
+            ++order_it;
+            continue;
+        }
+
         int idx = FUPool::NoNeedFU;
         Cycles op_latency = Cycles(1);
         ThreadID tid = issuing_inst->threadNumber;
 
         if (op_class != No_OpClass) {
-            idx = fuPool->getUnit(op_class);
+            idx = clustered() ?
+                fuPool->getUnit(op_class, issuing_inst->iqCluster,
+                                numClusters) :
+                fuPool->getUnit(op_class);
             if (issuing_inst->isFloating()) {
                 iqIOStats.fpAluAccesses++;
             } else if (issuing_inst->isVector()) {
@@ -880,6 +1052,12 @@ InstructionQueue::scheduleReadyInsts()
             readyInsts[op_class].pop();
 
             if (!readyInsts[op_class].empty()) {
+                if (issuing_inst->isCritical() &&
+                    !readyInsts[op_class].top()->isCritical() &&
+                    readyInsts[op_class].top()->seqNum <
+                    issuing_inst->seqNum) {
+                    ++iqStats.criticalBypasses;
+                }
                 moveToYoungerInst(order_it);
             } else {
                 readyIt[op_class] = listOrder.end();
@@ -887,7 +1065,23 @@ InstructionQueue::scheduleReadyInsts()
             }
 
             issuing_inst->setIssued();
-            ++total_issued;
+
+            if (cpu->regFile.banked()) {
+                cpu->regFile.readPorts(issuing_inst, cpu->curCycle(), true);
+            }
+
+            if (specLoadWakeup && issuing_inst->isLoad() &&
+                !issuing_inst->isRunahead() &&
+                !issuing_inst->isValuePredicted() &&
+                !issuing_inst->isMemRenamed() &&
+                issuing_inst->numDestRegs() > 0) {
+                pendingSpecWakeups.emplace_back(
+                        cpu->curCycle() + loadHitLatency, issuing_inst);
+            }
+
+            // A fused tail issues as part of its head's macro-op.
+            if (!issuing_inst->isFusedTail())
+                ++total_issued;
 
 #if TRACING_ON
             issuing_inst->issueTick = curTick() - issuing_inst->fetchTick;
@@ -898,10 +1092,16 @@ InstructionQueue::scheduleReadyInsts()
 
             if (!issuing_inst->isMemRef()) {
                 // Memory instructions can not be freed from the IQ until they
-                // complete.
-                ++freeEntries;
-                count[tid]--;
-                issuing_inst->clearInIQ();
+                // complete. An instruction woken by a load that may still
+                // miss keeps its entry until it has read its operands.
+                if (!specLoadWakeup || !issuedInLoadShadow(issuing_inst)) {
+                    if (!issuing_inst->isFusedTail()) {
+                        ++freeEntries;
+                        count[tid]--;
+                        releaseCluster(issuing_inst);
+                    }
+                    issuing_inst->clearInIQ();
+                }
             } else {
                 memDepUnit[tid].issue(issuing_inst);
             }
@@ -916,6 +1116,16 @@ InstructionQueue::scheduleReadyInsts()
         }
     }
 
+    if (read_port_stall)
+        ++iqStats.regReadPortStallCycles;
+
+    if (clustered()) {
+        auto occupancy = std::minmax_element(clusterCount.begin(),
+                                             clusterCount.end());
+        iqStats.clusterImbalance.sample(*occupancy.second -
+                                        *occupancy.first);
+    }
+
     iqStats.numIssuedDist.sample(total_issued);
     iqStats.instsIssued+= total_issued;
 
@@ -923,7 +1133,8 @@ InstructionQueue::scheduleReadyInsts()
     // @todo If the way deferred memory instructions are handeled due to
     // translation changes then the deferredMemInsts condition should be
     // removed from the code below.
-    if (total_issued || !retryMemInsts.empty() || !deferredMemInsts.empty()) {
+    if (total_issued || !retryMemInsts.empty() || !deferredMemInsts.empty() ||
+        !bypassInsts.empty()) {
         cpu->activityThisCycle();
     } else {
         DPRINTF(IQ, "Not able to schedule any instructions.\n");
@@ -1004,15 +1215,41 @@ InstructionQueue::wakeDependents(const DynInstPtr &completed_inst)
         DPRINTF(IQ, "Completing mem instruction PC: %s [sn:%llu]\n",
             completed_inst->pcState(), completed_inst->seqNum);
 
-        ++freeEntries;
         completed_inst->memOpDone(true);
-        count[tid]--;
+        if (!completed_inst->isFusedTail()) {
+            ++freeEntries;
+            count[tid]--;
+            releaseCluster(completed_inst);
+        }
     } else if (completed_inst->isReadBarrier() ||
                completed_inst->isWriteBarrier()) {
         // Completes a non mem ref barrier
         memDepUnit[tid].completeInst(completed_inst);
     }
 
+    // A value predicted load already woke its dependents at dispatch,
+    // and a memory renamed load's destination belongs to its store.
+    if (!completed_inst->isValuePredicted() &&
+        !completed_inst->isMemRenamed()) {
+        dependents = wakeRegDependents(completed_inst);
+    }
+
+    // Instructions that many others wait on, such as loads feeding long
+    // chains, are worth issuing early next time.
+    if (issuePolicy == IssuePolicy::CriticalFirst &&
+        dependents >= criticalFanout) {
+        ++iqStats.critTrainFanouts;
+        critPred.trainCritical(completed_inst->pcState().instAddr());
+    }
+
+    return dependents;
+}
+
+int
+InstructionQueue::wakeRegDependents(const DynInstPtr &completed_inst)
+{
+    int dependents = 0;
+
     for (int dest_reg_idx = 0;
          dest_reg_idx < completed_inst->numDestRegs();
          dest_reg_idx++)
@@ -1057,6 +1294,8 @@ InstructionQueue::wakeDependents(const DynInstPtr &completed_inst)
             // graph entries would need to hold the src_reg_idx.
             dep_inst->markSrcRegReady();
 
+            wakeAcrossClusters(completed_inst, dep_inst);
+
             addIfReady(dep_inst);
 
             dep_inst = dependGraph.pop(dest_reg->flatIndex());
@@ -1071,10 +1310,215 @@ InstructionQueue::wakeDependents(const DynInstPtr &completed_inst)
 
         // Mark the scoreboard as having that register ready.
         regScoreboard[dest_reg->flatIndex()] = true;
+        specReadyRegs[dest_reg->flatIndex()] = false;
     }
     return dependents;
 }
 
+void
+InstructionQueue::wakeSpecLoadDependents()
+{
+    // Loads that have written back or been squashed no longer need to be
+    // tracked for replay.
+    specWokenLoads.remove_if([this](const DynInstPtr &load_inst) {
+        return load_inst->isSquashed() ||
+            regScoreboard[load_inst->renamedDestIdx(0)->flatIndex()];
+    });
+
+    Cycles cur_cycle = cpu->curCycle();
+
+    while (!pendingSpecWakeups.empty() &&
+           pendingSpecWakeups.front().first <= cur_cycle) {
+        DynInstPtr load_inst = pendingSpecWakeups.front().second;
+        pendingSpecWakeups.pop_front();
+
+        if (load_inst->isSquashed()) {
+            continue;
+        }
+
+        if (specWakeRegDependents(load_inst)) {
+            ++iqStats.specWakeupLoads;
+            specWokenLoads.push_back(load_inst);
+        }
+    }
+}
+
+int
+InstructionQueue::specWakeRegDependents(const DynInstPtr &load_inst)
+{
+    int dependents = 0;
+
+    for (int dest_reg_idx = 0;
+         dest_reg_idx < load_inst->numDestRegs();
+         dest_reg_idx++)
+    {
+        PhysRegIdPtr dest_reg = load_inst->renamedDestIdx(dest_reg_idx);
+
+        // Registers already written back have woken their dependents.
+        if (dest_reg->isFixedMapping() || dest_reg->isPinned() ||
+            regScoreboard[dest_reg->flatIndex()]) {
+            continue;
+        }
+
+        specReadyRegs[dest_reg->flatIndex()] = true;
+
+        std::vector<DynInstPtr> still_waiting;
+        DynInstPtr dep_inst;
+
+        while ((dep_inst = dependGraph.pop(dest_reg->flatIndex()))) {
+            // Non-speculative instructions only issue at commit, long
+            // after the load's data is back.
+            bool marked = false;
+            if (!dep_inst->isNonSpeculative()) {
+                for (int src_reg_idx = 0;
+                     src_reg_idx < dep_inst->numSrcRegs();
+                     src_reg_idx++)
+                {
+                    if (dep_inst->renamedSrcIdx(src_reg_idx) == dest_reg &&
+                        !dep_inst->readySrcIdx(src_reg_idx)) {
+                        // Unlike a real wakeup, the source is marked so
+                        // the instruction can be put back on replay.
+                        dep_inst->markSrcRegReady(src_reg_idx);
+                        marked = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!marked) {
+                still_waiting.push_back(dep_inst);
+                continue;
+            }
+
+            DPRINTF(IQ, "Speculatively waking up a dependent instruction, "
+                    "[sn:%llu] PC %s.\n", dep_inst->seqNum,
+                    dep_inst->pcState());
+
+            wakeAcrossClusters(load_inst, dep_inst);
+
+            addIfReady(dep_inst);
+
+            ++dependents;
+        }
+
+        for (auto &inst : still_waiting) {
+            dependGraph.insert(dest_reg->flatIndex(), inst);
+        }
+    }
+
+    iqStats.specWokenInsts += dependents;
+
+    return dependents;
+}
+
+bool
+InstructionQueue::issuedInLoadShadow(const DynInstPtr &inst)
+{
+    for (int src_reg_idx = 0; src_reg_idx < inst->numSrcRegs();
+         src_reg_idx++) {
+        PhysRegIdPtr src_reg = inst->renamedSrcIdx(src_reg_idx);
+        if (!src_reg->isFixedMapping() &&
+            inst->readySrcIdx(src_reg_idx) &&
+            specReadyRegs[src_reg->flatIndex()]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::list<DynInstPtr>::iterator
+InstructionQueue::findMissingLoad(PhysRegIdPtr reg)
+{
+    for (auto it = specWokenLoads.begin(); it != specWokenLoads.end();
+         ++it) {
+        const DynInstPtr &load_inst = *it;
+        if (load_inst->isSquashed() || load_inst->isExecuted()) {
+            continue;
+        }
+        for (int dest_reg_idx = 0; dest_reg_idx < load_inst->numDestRegs();
+             dest_reg_idx++) {
+            if (load_inst->renamedDestIdx(dest_reg_idx) == reg) {
+                return it;
+            }
+        }
+    }
+    return specWokenLoads.end();
+}
+
+bool
+InstructionQueue::replayIfLoadMissed(const DynInstPtr &inst)
+{
+    if (!specLoadWakeup) {
+        return false;
+    }
+
+    for (int src_reg_idx = 0; src_reg_idx < inst->numSrcRegs();
+         src_reg_idx++) {
+        PhysRegIdPtr src_reg = inst->renamedSrcIdx(src_reg_idx);
+        if (!src_reg->isFixedMapping() &&
+            specReadyRegs[src_reg->flatIndex()] &&
+            findMissingLoad(src_reg) != specWokenLoads.end()) {
+            replayInst(inst);
+            return true;
+        }
+    }
+
+    // The load's data is in the register file; the entry kept through
+    // its shadow is no longer needed.
+    if (!inst->isMemRef() && inst->isInIQ()) {
+        if (!inst->isFusedTail()) {
+            ++freeEntries;
+            count[inst->threadNumber]--;
+            releaseCluster(inst);
+        }
+        inst->clearInIQ();
+    }
+
+    return false;
+}
+
+void
+InstructionQueue::replayInst(const DynInstPtr &inst)
+{
+    DPRINTF(IQ, "[sn:%llu] PC %s read its operands before its load's data "
+            "returned, replaying.\n", inst->seqNum, inst->pcState());
+
+    ++iqStats.replayedInsts;
+
+    inst->clearIssued();
+
+    for (int src_reg_idx = 0; src_reg_idx < inst->numSrcRegs();
+         src_reg_idx++) {
+        PhysRegIdPtr src_reg = inst->renamedSrcIdx(src_reg_idx);
+        if (src_reg->isFixedMapping() ||
+            !specReadyRegs[src_reg->flatIndex()]) {
+            continue;
+        }
+
+        auto load_it = findMissingLoad(src_reg);
+        if (load_it == specWokenLoads.end()) {
+            continue;
+        }
+
+        inst->markSrcRegNotReady(src_reg_idx);
+        dependGraph.insert(src_reg->flatIndex(), inst);
+
+        if (replayPolicy != LoadReplayPolicy::Squash) {
+            continue;
+        }
+
+        // Squash once from each missing load; its other dependents are
+        // younger and go with the squash.
+        ++iqStats.replaySquashes;
+        iewStage->squashDueToLoadReplay(*load_it);
+        specWokenLoads.erase(load_it);
+    }
+
+    if (inst->isMemRef()) {
+        memDepUnit[inst->threadNumber].regsNotReady(inst);
+    }
+}
+
 void
 InstructionQueue::addReadyMemInst(const DynInstPtr &ready_inst)
 {
@@ -1083,10 +1527,11 @@ InstructionQueue::addReadyMemInst(const DynInstPtr &ready_inst)
     readyInsts[op_class].push(ready_inst);
 
     // Will need to reorder the list if either a queue is not on the list,
-    // or it has an older instruction than last time.
+    // or it has a different instruction at its top than last time, which
+    // is older unless a critical instruction went ahead of it.
     if (!queueOnList[op_class]) {
         addToOrderList(op_class);
-    } else if (readyInsts[op_class].top()->seqNum  <
+    } else if (readyInsts[op_class].top()->seqNum !=
                (*readyIt[op_class]).oldestInst) {
         listOrder.erase(readyIt[op_class]);
         addToOrderList(op_class);
@@ -1227,7 +1672,8 @@ InstructionQueue::doSquash(ThreadID tid)
 
         if (!squashed_inst->isIssued() ||
             (squashed_inst->isMemRef() &&
-             !squashed_inst->memOpDone())) {
+             !squashed_inst->memOpDone()) ||
+            (!squashed_inst->isMemRef() && squashed_inst->isInIQ())) {
 
             DPRINTF(IQ, "[tid:%i] Instruction [sn:%llu] PC %s squashed.\n",
                     tid, squashed_inst->seqNum, squashed_inst->pcState());
@@ -1306,9 +1752,12 @@ InstructionQueue::doSquash(ThreadID tid)
             squashed_inst->clearInIQ();
 
             //Update Thread IQ Count
-            count[squashed_inst->threadNumber]--;
+            if (!squashed_inst->isFusedTail()) {
+                count[squashed_inst->threadNumber]--;
 
-            ++freeEntries;
+                ++freeEntries;
+                releaseCluster(squashed_inst);
+            }
         }
 
         // IQ clears out the heads of the dependency graph only when
@@ -1339,9 +1788,162 @@ bool
 InstructionQueue::PqCompare::operator()(
         const DynInstPtr &lhs, const DynInstPtr &rhs) const
 {
+    if (lhs->isCritical() != rhs->isCritical())
+        return rhs->isCritical();
     return lhs->seqNum > rhs->seqNum;
 }
 
+void
+InstructionQueue::markIfCritical(const DynInstPtr &inst)
+{
+    bool critical = critPred.isCritical(inst->pcState().instAddr()) ||
+        inDVRChain(inst);
+
+    if (critical) {
+        DPRINTF(IQ, "[sn:%llu] PC %s is predicted critical.\n",
+                inst->seqNum, inst->pcState());
+        inst->setCritical();
+        ++iqStats.criticalInsts;
+    }
+}
+
+bool
+InstructionQueue::inDVRChain(const DynInstPtr &inst)
+{
+    if (cpu->isStridePC(inst->pcState().instAddr()))
+        return true;
+
+    // Members of a DVR chain consume a stride load's value, directly or
+    // through other chain members.
+    for (int src_reg_idx = 0; src_reg_idx < inst->numSrcRegs();
+         src_reg_idx++) {
+        if (cpu->taintScoreboard.isRegTainted(
+                inst->renamedSrcIdx(src_reg_idx))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+InstructionQueue::steer(const DynInstPtr &inst)
+{
+    if (!clustered())
+        return;
+
+    // A fused tail shares the entry, and so the cluster, of its head.
+    if (inst->isFusedTail()) {
+        assert(!instList[inst->threadNumber].empty());
+        inst->iqCluster = instList[inst->threadNumber].back()->iqCluster;
+        return;
+    }
+
+    unsigned general = dvrCluster ? numClusters - 1 : numClusters;
+    unsigned cluster;
+
+    if (dvrCluster && inDVRChain(inst)) {
+        cluster = numClusters - 1;
+    } else {
+        cluster = leastLoadedCluster(general);
+
+        // Follow the producer of the first operand still in flight, so
+        // the value need not cross the bypass.
+        for (int src_reg_idx = 0;
+             steeringPolicy == IQSteeringPolicy::Dependence &&
+             src_reg_idx < inst->numSrcRegs();
+             src_reg_idx++) {
+            PhysRegIdPtr src_reg = inst->renamedSrcIdx(src_reg_idx);
+            if (inst->readySrcIdx(src_reg_idx) ||
+                src_reg->isFixedMapping() ||
+                regScoreboard[src_reg->flatIndex()] ||
+                regCluster[src_reg->flatIndex()] >= general) {
+                continue;
+            }
+            cluster = regCluster[src_reg->flatIndex()];
+            break;
+        }
+    }
+
+    if (clusterCount[cluster] >= clusterEntries) {
+        cluster = leastLoadedCluster(numClusters);
+        ++iqStats.steeringOverflows;
+    }
+
+    assert(clusterCount[cluster] < clusterEntries);
+
+    DPRINTF(IQ, "[sn:%llu] PC %s steered to cluster %u.\n",
+            inst->seqNum, inst->pcState(), cluster);
+
+    inst->iqCluster = cluster;
+    ++clusterCount[cluster];
+    ++iqStats.clusterInsts[cluster];
+}
+
+unsigned
+InstructionQueue::leastLoadedCluster(unsigned num_clusters)
+{
+    return std::min_element(clusterCount.begin(),
+                            clusterCount.begin() + num_clusters) -
+        clusterCount.begin();
+}
+
+void
+InstructionQueue::releaseCluster(const DynInstPtr &inst)
+{
+    if (!clustered())
+        return;
+
+    assert(clusterCount[inst->iqCluster] > 0);
+    --clusterCount[inst->iqCluster];
+}
+
+void
+InstructionQueue::wakeAcrossClusters(const DynInstPtr &producer,
+                                     const DynInstPtr &consumer)
+{
+    if (!clustered() || producer->iqCluster == consumer->iqCluster)
+        return;
+
+    ++iqStats.crossClusterWakeups;
+    consumer->clusterReadyCycle = std::max(consumer->clusterReadyCycle,
+            cpu->curCycle() + clusterBypassLatency);
+}
+
+void
+InstructionQueue::drainBypass()
+{
+    Cycles cur_cycle = cpu->curCycle();
+
+    auto it = bypassInsts.begin();
+    while (it != bypassInsts.end()) {
+        DynInstPtr inst = *it;
+        if (inst->isSquashed()) {
+            it = bypassInsts.erase(it);
+        } else if (inst->clusterReadyCycle <= cur_cycle) {
+            it = bypassInsts.erase(it);
+            addIfReady(inst);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+InstructionQueue::trainCriticality(const DynInstPtr &inst, bool critical)
+{
+    if (issuePolicy != IssuePolicy::CriticalFirst) {
+        return;
+    }
+
+    if (critical) {
+        ++iqStats.critTrainHeadStalls;
+        critPred.trainCritical(inst->pcState().instAddr());
+    } else {
+        critPred.trainNonCritical(inst->pcState().instAddr());
+    }
+}
+
 bool
 InstructionQueue::addToDependents(const DynInstPtr &new_inst)
 {
@@ -1396,6 +1998,12 @@ InstructionQueue::addToProducers(const DynInstPtr &new_inst)
     // the producer of a register's value, but for convenience a ptr
     // to the producing instruction will be placed in the head node of
     // the dependency links.
+    // A memory renamed load shares the data register of its store, whose
+    // producer remains responsible for waking the register's dependents.
+    if (new_inst->isMemRenamed()) {
+        return;
+    }
+
     int8_t total_dest_regs = new_inst->numDestRegs();
 
     for (int dest_reg_idx = 0;
@@ -1418,9 +2026,11 @@ InstructionQueue::addToProducers(const DynInstPtr &new_inst)
         }
 
         dependGraph.setInst(dest_reg->flatIndex(), new_inst);
+        regCluster[dest_reg->flatIndex()] = new_inst->iqCluster;
 
         // Mark the scoreboard to say it's not yet ready.
         regScoreboard[dest_reg->flatIndex()] = false;
+        specReadyRegs[dest_reg->flatIndex()] = false;
     }
 }
 
@@ -1431,6 +2041,19 @@ InstructionQueue::addIfReady(const DynInstPtr &inst)
     // available, then add it to the list of ready instructions.
     if (inst->readyToIssue()) {
 
+        // An operand woken from another cluster is still on the bypass;
+        // keep the instruction off the ready list until it arrives so
+        // it does not hold up the rest of its op class.
+        if (inst->clusterReadyCycle > cpu->curCycle()) {
+            DPRINTF(IQ, "Instruction PC %s [sn:%llu] waits %llu cycles on "
+                    "the inter-cluster bypass.\n", inst->pcState(),
+                    inst->seqNum,
+                    inst->clusterReadyCycle - cpu->curCycle());
+            ++iqStats.clusterBypassStalls;
+            bypassInsts.push_back(inst);
+            return;
+        }
+
         //Add the instruction to the proper ready list.
         if (inst->isMemRef()) {
 
@@ -1452,10 +2075,11 @@ InstructionQueue::addIfReady(const DynInstPtr &inst)
         readyInsts[op_class].push(inst);
 
         // Will need to reorder the list if either a queue is not on the list,
-        // or it has an older instruction than last time.
+        // or it has a different instruction at its top than last time, which
+        // is older unless a critical instruction went ahead of it.
         if (!queueOnList[op_class]) {
             addToOrderList(op_class);
-        } else if (readyInsts[op_class].top()->seqNum  <
+        } else if (readyInsts[op_class].top()->seqNum !=
                    (*readyIt[op_class]).oldestInst) {
             listOrder.erase(readyIt[op_class]);
             addToOrderList(op_class);
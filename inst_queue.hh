@@ -51,6 +51,7 @@
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/comm.hh"
+#include "cpu/o3/crit_pred.hh"
 #include "cpu/o3/dep_graph.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/limits.hh"
@@ -58,6 +59,9 @@
 #include "cpu/o3/store_set.hh"
 #include "cpu/op_class.hh"
 #include "cpu/timebuf.hh"
+#include "enums/IQSteeringPolicy.hh"
+#include "enums/IssuePolicy.hh"
+#include "enums/LoadReplayPolicy.hh"
 #include "enums/SMTQueuePolicy.hh"
 #include "sim/eventq.hh"
 
@@ -220,6 +224,13 @@ class InstructionQueue
     /** Process FU completion event. */
     void processFUCompletion(const DynInstPtr &inst, int fu_idx);
 
+    /** Checks an instruction about to read its operands. If a load that
+     * woke it speculatively has no data yet, it is put back to wait for
+     * the load and true is returned. Otherwise the IQ entry it kept
+     * through the load's shadow is freed.
+     */
+    bool replayIfLoadMissed(const DynInstPtr &inst);
+
     /**
      * Schedules ready instructions, adding the ready ones (oldest first) to
      * the queue to execute.
@@ -238,6 +249,12 @@ class InstructionQueue
     /** Wakes all dependents of a completed instruction. */
     int wakeDependents(const DynInstPtr &completed_inst);
 
+    /** Wakes the instructions waiting on the destination registers of an
+     * instruction, without completing it. Used directly for loads whose
+     * value is predicted at dispatch.
+     */
+    int wakeRegDependents(const DynInstPtr &completed_inst);
+
     /** Adds a ready memory instruction to the ready list. */
     void addReadyMemInst(const DynInstPtr &ready_inst);
 
@@ -265,6 +282,11 @@ class InstructionQueue
     /** Indicates an ordering violation between a store and a load. */
     void violation(const DynInstPtr &store, const DynInstPtr &faulting_load);
 
+    /** Trains the criticality predictor with an instruction that either
+     * stalled commit at the head of the ROB or committed without doing so.
+     */
+    void trainCriticality(const DynInstPtr &inst, bool critical);
+
     /**
      * Squashes instructions for a thread. Squashing information is obtained
      * from the time buffer.
@@ -281,6 +303,66 @@ class InstructionQueue
     /** Does the actual squashing. */
     void doSquash(ThreadID tid);
 
+    /** Wakes the dependents of loads issued an assumed L1 hit latency
+     * ago whose data has not been written back yet.
+     */
+    void wakeSpecLoadDependents();
+
+    /** Speculatively wakes the instructions waiting on a load's
+     * destination registers, without marking the registers ready.
+     * @return The number of instructions woken.
+     */
+    int specWakeRegDependents(const DynInstPtr &load_inst);
+
+    /** Marks a newly inserted instruction critical if it is predicted
+     * critical or belongs to a DVR stride load chain.
+     */
+    void markIfCritical(const DynInstPtr &inst);
+
+    /** Returns whether an instruction is a DVR stride load or consumes
+     * one's value, directly or through other chain members.
+     */
+    bool inDVRChain(const DynInstPtr &inst);
+
+    /** Whether the IQ is split into clusters. */
+    bool clustered() const { return numClusters > 1; }
+
+    /** Picks the cluster of a newly inserted instruction. */
+    void steer(const DynInstPtr &inst);
+
+    /** Returns the least occupied of the first num_clusters clusters. */
+    unsigned leastLoadedCluster(unsigned num_clusters);
+
+    /** Frees an instruction's entry in its cluster. */
+    void releaseCluster(const DynInstPtr &inst);
+
+    /** Delays a woken consumer by the bypass latency if its producer is
+     * in another cluster.
+     */
+    void wakeAcrossClusters(const DynInstPtr &producer,
+                            const DynInstPtr &consumer);
+
+    /** Moves the instructions whose operands came off the inter-cluster
+     * bypass this cycle onto the ready lists.
+     */
+    void drainBypass();
+
+    /** Returns whether an instruction selected for issue was woken
+     * speculatively by a load that has not written back yet.
+     */
+    bool issuedInLoadShadow(const DynInstPtr &inst);
+
+    /** Returns the speculatively woken load writing a register whose
+     * data has not arrived yet, or specWokenLoads.end() if there is none.
+     */
+    std::list<DynInstPtr>::iterator findMissingLoad(PhysRegIdPtr reg);
+
+    /** Puts an instruction that read its operands in a load's miss shadow
+     * back to wait on that load's registers, squashing from the load
+     * instead if that is the replay policy.
+     */
+    void replayInst(const DynInstPtr &inst);
+
     /////////////////////////
     // Various pointers
     /////////////////////////
@@ -341,7 +423,8 @@ class InstructionQueue
      * This gives reverse ordering to the instructions in terms of
      * sequence numbers: the instructions with smaller sequence
      * numbers (and hence are older) will be at the top of the
-     * priority queue.
+     * priority queue. Instructions marked critical come before all
+     * non-critical ones.
      */
     struct PqCompare
     {
@@ -432,6 +515,68 @@ class InstructionQueue
     /** The total number of instructions that can be issued in one cycle. */
     unsigned totalWidth;
 
+    /** Whether load dependents are woken assuming an L1 hit. */
+    bool specLoadWakeup;
+
+    /** Cycles from a load's issue until its dependents are woken when
+     * waking speculatively.
+     */
+    Cycles loadHitLatency;
+
+    /** How dependents that issued before their load's data are replayed. */
+    LoadReplayPolicy replayPolicy;
+
+    /** Order in which ready instructions are selected for issue. */
+    IssuePolicy issuePolicy;
+
+    /** Predicts which instructions are critical, used when issuing
+     * critical instructions first.
+     */
+    CriticalityPredictor critPred;
+
+    /** Number of dependents a completing instruction must wake to be
+     * trained critical.
+     */
+    static constexpr int criticalFanout = 4;
+
+    /** Number of IQ clusters; 1 if the IQ is not clustered. */
+    unsigned numClusters;
+
+    /** Number of entries each cluster holds. */
+    unsigned clusterEntries;
+
+    /** How instructions are steered to clusters. */
+    IQSteeringPolicy steeringPolicy;
+
+    /** Extra cycles for a result to reach a consumer in another
+     * cluster.
+     */
+    Cycles clusterBypassLatency;
+
+    /** Whether the last cluster is kept for DVR stride load chains. */
+    bool dvrCluster;
+
+    /** Number of entries in use in each cluster. */
+    std::vector<unsigned> clusterCount;
+
+    /** Cluster of the last producer of each physical register. */
+    std::vector<unsigned> regCluster;
+
+    /** Ready instructions whose operand from another cluster is still on
+     * the bypass. They join the ready lists at their clusterReadyCycle.
+     */
+    std::list<DynInstPtr> bypassInsts;
+
+    /** Issued loads waiting for their speculative wakeup, with the cycle
+     * at which it happens, in issue order.
+     */
+    std::list<std::pair<Cycles, DynInstPtr>> pendingSpecWakeups;
+
+    /** Loads that woke dependents speculatively and have not written
+     * back yet.
+     */
+    std::list<DynInstPtr> specWokenLoads;
+
     /** The number of physical registers in the CPU. */
     unsigned numPhysRegs;
 
@@ -454,6 +599,11 @@ class InstructionQueue
      */
     std::vector<bool> regScoreboard;
 
+    /** Registers whose dependents were woken speculatively by a load
+     *  that has not written them back yet.
+     */
+    std::vector<bool> specReadyRegs;
+
     /** Adds an instruction to the dependency graph, as a consumer. */
     bool addToDependents(const DynInstPtr &new_inst);
 
@@ -541,6 +691,51 @@ class InstructionQueue
         statistics::Vector fuBusy;
         /** Number of times the FU was busy per instruction issued. */
         statistics::Formula fuBusyRate;
+
+        /** Stat for number of loads that woke dependents speculatively
+         *  before their data returned. */
+        statistics::Scalar specWakeupLoads;
+        /** Stat for number of instructions woken speculatively. */
+        statistics::Scalar specWokenInsts;
+        /** Stat for number of issued instructions replayed because their
+         *  load's data had not returned. */
+        statistics::Scalar replayedInsts;
+        /** Stat for number of squashes from a load due to replay. */
+        statistics::Scalar replaySquashes;
+        /** Number of replayed instructions per instruction issued. */
+        statistics::Formula replayRate;
+
+        /** Stat for number of instructions inserted marked critical. */
+        statistics::Scalar criticalInsts;
+        /** Stat for number of critical instructions that issued ahead of
+         *  an older ready instruction of the same op class. */
+        statistics::Scalar criticalBypasses;
+        /** Stat for number of times an instruction stalled commit at the
+         *  head of the ROB. */
+        statistics::Scalar critTrainHeadStalls;
+        /** Stat for number of times an instruction woke enough dependents
+         *  to be trained critical. */
+        statistics::Scalar critTrainFanouts;
+        /** Stat for number of times a ready instruction could not issue
+         *  for lack of a register file read port. */
+        statistics::Scalar regReadPortConflicts;
+        /** Stat for number of cycles in which a read port conflict held
+         *  back an instruction. */
+        statistics::Scalar regReadPortStallCycles;
+        /** Stat for number of instructions steered to each cluster. */
+        statistics::Vector clusterInsts;
+        /** Stat for number of instructions steered away from the
+         *  cluster the policy chose because it was full. */
+        statistics::Scalar steeringOverflows;
+        /** Distribution of the difference between the most and least
+         *  occupied clusters, sampled each cycle. */
+        statistics::Distribution clusterImbalance;
+        /** Stat for number of instructions woken by a producer in another
+         *  cluster. */
+        statistics::Scalar crossClusterWakeups;
+        /** Stat for number of ready instructions held back for an
+         *  operand on the inter-cluster bypass. */
+        statistics::Scalar clusterBypassStalls;
     } iqStats;
 
    public:
@@ -0,0 +1,51 @@
+#include "cpu/o3/lane_value.hh"
+
+#include <cstring>
+#include <limits>
+
+#include "base/bitfield.hh"
+#include "sim/byteswap.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+bool
+AffineFit::observe(uint64_t in, uint64_t out)
+{
+    if (hasFit && out == scale * in + offset)
+        return true;
+
+    hasFit = false;
+    if (hasObs && in != lastIn) {
+        int64_t d_in = in - lastIn;
+        int64_t d_out = out - lastOut;
+        // INT64_MIN / -1 overflows, so that one candidate is skipped
+        bool overflows = d_in == -1 &&
+            d_out == std::numeric_limits<int64_t>::min();
+        if (!overflows && d_out % d_in == 0) {
+            scale = d_out / d_in;
+            offset = out - scale * in;
+            hasFit = true;
+        }
+    }
+
+    hasObs = true;
+    lastIn = in;
+    lastOut = out;
+    return false;
+}
+
+uint64_t
+readLaneValue(const uint8_t *data, unsigned size)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, data, size);
+    value = letoh(value);
+    return size < sizeof(value) ? value & mask(size * 8) : value;
+}
+
+} // namespace o3
+} // namespace gem5
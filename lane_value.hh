@@ -0,0 +1,40 @@
+#ifndef __CPU_O3_LANE_VALUE_HH__
+#define __CPU_O3_LANE_VALUE_HH__
+
+#include <cstdint>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Fit of out = in * scale + offset over successive observations of a
+ * value pair, such as a chain instruction's input and output or an outer
+ * load's value and the start of its inner loop. Two observations with
+ * different inputs give a candidate, which is confirmed once it predicts
+ * a third.
+ */
+struct AffineFit
+{
+    bool hasObs = false;
+    bool hasFit = false;
+    uint64_t lastIn = 0;
+    uint64_t lastOut = 0;
+    uint64_t scale = 0;
+    uint64_t offset = 0;
+
+    /** Adds an observation; returns whether the fit predicted it. */
+    bool observe(uint64_t in, uint64_t out);
+};
+
+/** Reads a little endian value of up to eight bytes, as loaded by a lane
+ * or held by a store.
+ */
+uint64_t readLaneValue(const uint8_t *data, unsigned size);
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_LANE_VALUE_HH__
@@ -73,6 +73,7 @@ LSQ::LSQ(CPU *cpu_ptr, IEW *iew_ptr, const BaseO3CPUParams &params)
       _cacheBlocked(false),
       cacheStorePorts(params.cacheStorePorts), usedStorePorts(0),
       cacheLoadPorts(params.cacheLoadPorts), usedLoadPorts(0),
+      loadPairing(params.loadPairing),
       waitingForStaleTranslation(false),
       staleTranslationWaitTxnId(0),
       lsqPolicy(params.smtLSQPolicy),
@@ -87,6 +88,9 @@ LSQ::LSQ(CPU *cpu_ptr, IEW *iew_ptr, const BaseO3CPUParams &params)
 {
     assert(numThreads > 0 && numThreads <= MaxThreads);
 
+    maxResults = params.dvrLeadDistance;
+    computedResults.reserve(maxResults);
+
     //**********************************************
     //************ Handle SMT Parameters ***********
     //**********************************************
@@ -106,9 +110,16 @@ LSQ::LSQ(CPU *cpu_ptr, IEW *iew_ptr, const BaseO3CPUParams &params)
         DPRINTF(LSQ, "LSQ sharing policy set to Threshold: "
                 "%i entries per LQ | %i entries per SQ\n",
                 maxLQEntries,maxSQEntries);
+    } else if (lsqPolicy == SMTQueuePolicy::Adaptive) {
+        DPRINTF(LSQ, "LSQ sharing policy set to Adaptive\n");
     } else {
         panic("Invalid LSQ sharing policy. Options are: Dynamic, "
-                    "Partitioned, Threshold");
+                    "Partitioned, Threshold, Adaptive");
+    }
+
+    if (params.memRenaming) {
+        memRenamePred.init(name() + ".memRenamePred",
+                           params.memRenameTableSize);
     }
 
     thread.reserve(numThreads);
@@ -157,6 +168,13 @@ LSQ::isDrained() const
         drained = false;
     }
 
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        if (!thread[tid].writeBufferDrained()) {
+            DPRINTF(Drain, "Not drained, write buffer not empty.\n");
+            drained = false;
+        }
+    }
+
     return drained;
 }
 
@@ -180,6 +198,7 @@ LSQ::tick()
 
     usedLoadPorts = 0;
     usedStorePorts = 0;
+    pairLeaders.clear();
 }
 
 bool
@@ -217,6 +236,46 @@ LSQ::cachePortBusy(bool is_load)
     }
 }
 
+bool
+LSQ::pairable(PacketPtr pkt)
+{
+    const RequestPtr &req = pkt->req;
+    return pkt->isRead() && !pkt->isWrite() && !req->isLLSC() &&
+        !req->isUncacheable() && !req->isStrictlyOrdered() &&
+        !req->isLocalAccess() && !req->isHTMCmd() &&
+        !pkt->isHtmTransactional();
+}
+
+bool
+LSQ::pairLoad(PacketPtr pkt)
+{
+    if (!loadPairing || !pairable(pkt))
+        return false;
+
+    Addr line_mask = ~Addr(cpu->cacheLineSize() - 1);
+
+    for (auto it = pairLeaders.begin(); it != pairLeaders.end(); ++it) {
+        if (((*it)->getAddr() & line_mask) != (pkt->getAddr() & line_mask))
+            continue;
+
+        DPRINTF(LSQ, "Load to %#x paired with the access to %#x\n",
+                pkt->getAddr(), (*it)->getAddr());
+
+        pairedLoads[*it] = pkt;
+        pairLeaders.erase(it);
+        return true;
+    }
+
+    return false;
+}
+
+void
+LSQ::loadSent(PacketPtr pkt)
+{
+    if (loadPairing && pairable(pkt))
+        pairLeaders.push_back(pkt);
+}
+
 void
 LSQ::insertLoad(const DynInstPtr &load_inst)
 {
@@ -322,6 +381,12 @@ LSQ::getLoadHeadSeqNum(ThreadID tid)
     return thread.at(tid).getLoadHeadSeqNum();
 }
 
+DynInstPtr
+LSQ::oldestLongLatencyLoad(ThreadID tid, Cycles latency)
+{
+    return thread.at(tid).oldestLongLatencyLoad(latency);
+}
+
 int
 LSQ::getStoreHead(ThreadID tid)
 {
@@ -406,6 +471,59 @@ LSQ::recvTimingResp(PacketPtr pkt)
         DPRINTF(LSQ, "Got error packet back for address: %#X\n",
                 pkt->getAddr());
 
+    // Responses to write buffer lines only need to be counted off.
+    WriteBufferMarker *wbMarker =
+        dynamic_cast<WriteBufferMarker*>(pkt->senderState);
+    if (wbMarker) {
+        thread[wbMarker->tid].completeWriteBufferLine(pkt);
+        delete wbMarker;
+        delete pkt;
+        return true;
+    }
+
+    // Index prefetches lead on to the indirect access they point at.
+    IndirectPrefetchMarker *impMarker =
+        dynamic_cast<IndirectPrefetchMarker*>(pkt->senderState);
+    if (impMarker) {
+        if (impMarker->index && !pkt->isError()) {
+            cpu->indirectPrefetcher.indexArrived(impMarker->pc,
+                                                 impMarker->tid, pkt);
+        }
+        delete impMarker;
+        delete pkt;
+        return true;
+    }
+
+    // Runahead slice loads write their value back unless runahead has
+    // already ended.
+    RunaheadMarker *raMarker =
+        dynamic_cast<RunaheadMarker*>(pkt->senderState);
+    if (raMarker) {
+        DynInstPtr inst = raMarker->inst;
+        if (!inst->isSquashed()) {
+            inst->setExecuted();
+            inst->completeAcc(pkt);
+            iewStage->instToCommit(inst);
+            iewStage->activityThisCycle();
+        }
+        delete raMarker;
+        delete pkt;
+        return true;
+    }
+
+    // An outer loop lane of nested DVR starts a row of inner loop lanes.
+    NestedMarker *nestedMarker =
+        dynamic_cast<NestedMarker*>(pkt->senderState);
+    if (nestedMarker) {
+        if (!pkt->isError()) {
+            thread[nestedMarker->tid].nestedRowArrived(
+                    nestedMarker->outerPC, pkt);
+        }
+        delete nestedMarker;
+        delete pkt;
+        return true;
+    }
+
     // check if it is a vectorized stride load response
     VectorMarker *vectorMarker = dynamic_cast<VectorMarker*>(pkt->senderState);
     if (vectorMarker) {
@@ -431,10 +549,11 @@ LSQ::recvTimingResp(PacketPtr pkt)
             vectorLoadValues.push_back(value);  // save loaded value
             // printf("0x%08X (word)\n", value);
 
-            // 使用保存的 stride load PC
-            const auto* steps = cpu->taintScoreboard.getComputeSteps(currentStridePC);
+            // 使用 lane 所属的 stride load PC
+            Addr stridePC = vectorMarker->stridePC;
+            const auto* steps = cpu->taintScoreboard.getComputeSteps(stridePC);
             if (steps) {
-                uint64_t result = cpu->taintScoreboard.recomputeStepsForPC(currentStridePC, value);
+                uint64_t result = cpu->taintScoreboard.recomputeStepsForPC(stridePC, value);
                 printf("  Recomputed value: %#lx\n", result);
                 
                 // 存储计算结果
@@ -506,6 +625,19 @@ LSQ::recvTimingResp(PacketPtr pkt)
     LSQRequest *request = dynamic_cast<LSQRequest*>(pkt->senderState);
     panic_if(!request, "Got packet back with unknown sender state\n");
 
+    // The load paired with this one reads its bytes from the line this
+    // access has just brought in, and completes with it.
+    auto paired = pairedLoads.find(pkt);
+    if (paired != pairedLoads.end()) {
+        PacketPtr pair_pkt = paired->second;
+        pairedLoads.erase(paired);
+
+        dcachePort.sendFunctional(pair_pkt);
+        if (pair_pkt->needsResponse())
+            pair_pkt->makeResponse();
+        recvTimingResp(pair_pkt);
+    }
+
     thread[cpu->contextToThread(request->contextId())].recvTimingResp(pkt);
 
     if (pkt->isInvalidate()) {
@@ -835,6 +967,18 @@ LSQ::numStoresToWB(ThreadID tid)
     return thread.at(tid).numStoresToWB();
 }
 
+uint64_t
+LSQ::numSnoops(ThreadID tid)
+{
+    return thread.at(tid).numSnoops();
+}
+
+bool
+LSQ::snoopedSince(const DynInstPtr &load_inst)
+{
+    return thread.at(load_inst->threadNumber).snoopedSince(load_inst);
+}
+
 bool
 LSQ::willWB()
 {
@@ -881,6 +1025,11 @@ LSQ::pushRequest(const DynInstPtr& inst, bool isLoad, uint8_t *data,
         unsigned int size, Addr addr, Request::Flags flags, uint64_t *res,
         AtomicOpFunctorPtr amo_op, const std::vector<bool>& byte_enable)
 {
+    if (inst->isRunahead()) {
+        assert(isLoad);
+        return pushRunaheadRequest(inst, size, addr, flags);
+    }
+
     // This comming request can be either load, store or atomic.
     // Atomic request has a corresponding pointer to its atomic memory
     // operation
@@ -964,6 +1113,94 @@ LSQ::pushRequest(const DynInstPtr& inst, bool isLoad, uint8_t *data,
     return inst->getFault();
 }
 
+Fault
+LSQ::pushRunaheadRequest(const DynInstPtr& inst, unsigned int size,
+        Addr addr, Request::Flags flags)
+{
+    ThreadID tid = inst->threadNumber;
+    PreciseRunahead::PreciseRunaheadStats &pre_stats =
+        cpu->preciseRunahead.stats;
+
+    RequestPtr req = std::make_shared<Request>(addr, size, flags,
+            cpu->dataRequestorId(), inst->pcState().instAddr(),
+            inst->contextId());
+    req->taskId(cpu->taskId());
+
+    inst->effAddr = addr;
+    inst->effSize = size;
+    inst->effAddrValid(true);
+
+    // Runahead must not fault or touch devices, so anything that is not a
+    // plain cacheable single-line access is dropped.
+    bool send = !transferNeedsBurst(addr, size, cpu->cacheLineSize()) &&
+        !req->isLLSC() && !req->isHTMCmd() && !(flags & Request::TLBI_CMD) &&
+        cpu->mmu->translateFunctional(req, cpu->tcBase(tid),
+                                      BaseMMU::Read) == NoFault &&
+        !req->isUncacheable() && !req->isStrictlyOrdered() &&
+        !req->isLocalAccess() && !_cacheBlocked && cachePortAvailable(true);
+
+    if (send) {
+        PacketPtr pkt = Packet::createRead(req);
+        pkt->allocate();
+        pkt->senderState = new RunaheadMarker(inst);
+
+        if (dcachePort.sendTimingReq(pkt)) {
+            DPRINTF(LSQ, "[tid:%i] Runahead load [sn:%llu] prefetching "
+                    "%#x\n", tid, inst->seqNum, req->getPaddr());
+            cachePortBusy(true);
+            ++pre_stats.prefetches;
+            return NoFault;
+        }
+
+        cacheBlocked(true);
+        delete pkt->senderState;
+        delete pkt;
+    }
+
+    DPRINTF(LSQ, "[tid:%i] Runahead load [sn:%llu] to %#x dropped\n",
+            tid, inst->seqNum, addr);
+    ++pre_stats.droppedLoads;
+
+    inst->setExecuted();
+    iewStage->instToCommit(inst);
+    iewStage->activityThisCycle();
+
+    return NoFault;
+}
+
+bool
+LSQ::sendPrefetch(ThreadID tid, Addr addr, unsigned size, Addr pc,
+                  Packet::SenderState *marker)
+{
+    gem5::ThreadContext *tc = cpu->tcBase(tid);
+
+    RequestPtr req = std::make_shared<Request>(addr, size, 0,
+            cpu->dataRequestorId(), pc, tc->contextId());
+    req->taskId(cpu->taskId());
+
+    bool send = !transferNeedsBurst(addr, size, cpu->cacheLineSize()) &&
+        cpu->mmu->translateFunctional(req, tc, BaseMMU::Read) == NoFault &&
+        !req->isUncacheable() && !req->isStrictlyOrdered() &&
+        !req->isLocalAccess() && !_cacheBlocked && cachePortAvailable(true);
+
+    if (send) {
+        PacketPtr pkt = Packet::createRead(req);
+        pkt->allocate();
+        pkt->senderState = marker;
+
+        if (dcachePort.sendTimingReq(pkt)) {
+            cachePortBusy(true);
+            return true;
+        }
+
+        cacheBlocked(true);
+        delete pkt;
+    }
+
+    delete marker;
+    return false;
+}
+
 void
 LSQ::SingleDataRequest::finish(const Fault &fault, const RequestPtr &request,
         gem5::ThreadContext* tc, BaseMMU::Mode mode)
@@ -1649,29 +1886,30 @@ LSQ::getStrideValue(Addr pc) const
     return 0;
 }
 
-// 存储向量加载的计算结果
-uint64_t LSQ::computedResults[5];  // 存储5个计算结果
-int LSQ::numResults;               // 当前结果数量
-bool LSQ::resultsReady;           // 结果是否准备好
-
 // 初始化结果存储
 void LSQ::initResults() {
+    computedResults.clear();
     numResults = 0;
     resultsReady = false;
 }
 
 // 添加一个计算结果
 void LSQ::addComputedResult(uint64_t result) {
-    if (numResults < 5) {
-        computedResults[numResults++] = result;
-        if (numResults == 4) {  // 当收集到4个结果时
+    if (numResults < maxResults) {
+        computedResults.push_back(result);
+        numResults++;
+        // 当收集到一批结果时
+        if (numResults == std::min(resultBatch, maxResults)) {
             resultsReady = true;
         }
     }
 }
 
 // 获取计算结果
-const uint64_t* LSQ::getComputedResults() const { return computedResults; }
+const uint64_t* LSQ::getComputedResults() const
+{
+    return computedResults.data();
+}
 bool LSQ::hasResults() const { return resultsReady; }
 
 } // namespace o3
@@ -55,6 +55,7 @@
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/mem_rename.hh"
 #include "cpu/utils.hh"
 #include "enums/SMTQueuePolicy.hh"
 #include "mem/port.hh"
@@ -77,7 +78,24 @@ class LSQUnit;
 class VectorMarker : public Packet::SenderState
 {
   public:
-    VectorMarker() {}
+    VectorMarker(Addr _stridePC) : stridePC(_stridePC) {}
+
+    /** The stride load whose chain the lane's value is run through. */
+    Addr stridePC;
+};
+
+/** Marks an outer loop lane of nested DVR, whose value gives the start of
+ * a future row of inner loop lanes.
+ */
+class NestedMarker : public Packet::SenderState
+{
+  public:
+    NestedMarker(ThreadID _tid, Addr _outerPC)
+        : tid(_tid), outerPC(_outerPC)
+    {}
+
+    ThreadID tid;
+    Addr outerPC;
 };
 
 // 用于标记依赖加载的请求
@@ -87,6 +105,39 @@ class DependentMarker : public Packet::SenderState
     DependentMarker() {}
 };
 
+/** Marks a line write drained from a thread's store write buffer. */
+class WriteBufferMarker : public Packet::SenderState
+{
+  public:
+    WriteBufferMarker(ThreadID _tid) : tid(_tid) {}
+
+    ThreadID tid;
+};
+
+/** Marks a prefetch sent for a Precise Runahead slice load. */
+class RunaheadMarker : public Packet::SenderState
+{
+  public:
+    RunaheadMarker(const DynInstPtr &_inst) : inst(_inst) {}
+
+    DynInstPtr inst;
+};
+
+/** Marks a prefetch sent by the Indirect Memory Prefetcher. */
+class IndirectPrefetchMarker : public Packet::SenderState
+{
+  public:
+    IndirectPrefetchMarker(ThreadID _tid, Addr _pc, bool _index)
+        : tid(_tid), pc(_pc), index(_index)
+    {}
+
+    ThreadID tid;
+    /** PC of the load the prefetch was made for. */
+    Addr pc;
+    /** Whether this prefetches an index rather than an indirect access. */
+    bool index;
+};
+
 class LSQ
 {
   public:
@@ -750,6 +801,11 @@ class LSQ
     /** Returns the sequence number of the head of the load queue. */
     InstSeqNum getLoadHeadSeqNum(ThreadID tid);
 
+    /** Returns the oldest load of a thread that has been waiting on memory
+     * for at least the given latency, or nullptr if there is none.
+     */
+    DynInstPtr oldestLongLatencyLoad(ThreadID tid, Cycles latency);
+
     /** Returns the head index of the store queue. */
     int getStoreHead(ThreadID tid);
 
@@ -842,6 +898,14 @@ class LSQ
     /** Returns the number of stores a specific thread has to write back. */
     int numStoresToWB(ThreadID tid);
 
+    /** Returns the number of invalidations a specific thread has snooped. */
+    uint64_t numSnoops(ThreadID tid);
+
+    /** Returns whether a line a load read may have been invalidated since
+     * it executed.
+     */
+    bool snoopedSince(const DynInstPtr &load_inst);
+
     /** Returns if the LSQ will write back to memory this cycle. */
     bool willWB();
     /** Returns if the LSQ of a specific thread will write back to memory this
@@ -890,6 +954,26 @@ class LSQ
                       uint64_t *res, AtomicOpFunctorPtr amo_op,
                       const std::vector<bool>& byte_enable);
 
+    /**
+     * Executes a Precise Runahead slice load. The load is translated
+     * functionally and sent straight to the cache without an LQ entry.
+     * If it cannot be sent it completes at once and its destination
+     * keeps a stale value; runahead results are never committed.
+     */
+    Fault pushRunaheadRequest(const DynInstPtr& inst, unsigned int size,
+                              Addr addr, Request::Flags flags);
+
+    /**
+     * Sends a prefetch for a thread straight to the cache, translating
+     * its virtual address functionally. Prefetches that would fault,
+     * touch a device or cross a line, or find no free load port, are
+     * dropped.
+     * @param marker Sender state of the packet; freed if it is dropped.
+     * @return Whether the prefetch was sent.
+     */
+    bool sendPrefetch(ThreadID tid, Addr addr, unsigned size, Addr pc,
+                      Packet::SenderState *marker);
+
     /** The CPU pointer. */
     CPU *cpu;
 
@@ -905,8 +989,22 @@ class LSQ
     /** Another store port is in use */
     void cachePortBusy(bool is_load);
 
+    /** Pairs a load packet with a load to the same line sent to the cache
+     * this cycle, so that it completes on that load's access.
+     * @return Whether the packet was paired.
+     */
+    bool pairLoad(PacketPtr pkt);
+
+    /** Offers a load packet just sent to the cache for pairing. */
+    void loadSent(PacketPtr pkt);
+
     RequestPort &getDataPort() { return dcachePort; }
 
+    /** Memory renaming predictor, trained by store-to-load forwarding
+     * and consulted by rename.
+     */
+    MemRenamePredictor memRenamePred;
+
     int getStrideValue(Addr pc) const;
 
     // 存储向量加载的值
@@ -915,16 +1013,18 @@ class LSQ
     // 获取向量加载的值
     const std::vector<uint64_t>& getVectorLoadValues() const { return vectorLoadValues; }
 
-    // 存储当前 stride load 的 PC
-    Addr currentStridePC;
+    // 存储向量加载的计算结果, one per lane up to the lead distance
+    std::vector<uint64_t> computedResults;
+    int numResults = 0;                  // 当前结果数量
+    bool resultsReady = false;           // 结果是否准备好
 
-    // 设置当前 stride load PC
-    void setCurrentStridePC(Addr pc) { currentStridePC = pc; }
+    /** Lane results held for the dependent gather, which is the DVR
+     * lead distance.
+     */
+    int maxResults = 0;
 
-    // 存储向量加载的计算结果
-    static uint64_t computedResults[5];  // 存储5个计算结果
-    static int numResults;               // 当前结果数量
-    static bool resultsReady;           // 结果是否准备好
+    /** Lane results that make a batch worth starting the gather for. */
+    static constexpr int resultBatch = 4;
 
     // 初始化结果存储
     void initResults();
@@ -948,6 +1048,18 @@ class LSQ
     /** The number of used cache ports in this cycle by loads. */
     int usedLoadPorts;
 
+    /** Whether loads to the same line may share a cache access. */
+    bool loadPairing;
+
+    /** Loads sent to the cache this cycle that have no pair yet. */
+    std::vector<PacketPtr> pairLeaders;
+
+    /** Paired loads, keyed by the packet whose access they share. */
+    std::map<PacketPtr, PacketPtr> pairedLoads;
+
+    /** Returns whether a load packet may be part of a pair. */
+    static bool pairable(PacketPtr pkt);
+
     /** If the LSQ is currently waiting for stale translations */
     bool waitingForStaleTranslation;
     /** The ID if the transaction that made translations stale */
@@ -965,7 +1077,9 @@ class LSQ
     maxLSQAllocation(SMTQueuePolicy pol, uint32_t entries,
             uint32_t numThreads, uint32_t SMTThreshold)
     {
-        if (pol == SMTQueuePolicy::Dynamic) {
+        if (pol == SMTQueuePolicy::Dynamic ||
+            pol == SMTQueuePolicy::Adaptive) {
+            // Adaptive shares are enforced at rename.
             return entries;
         } else if (pol == SMTQueuePolicy::Partitioned) {
             //@todo:make work if part_amt doesnt divide evenly.
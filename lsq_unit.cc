@@ -43,6 +43,7 @@
 #include "cpu/o3/vir.hh"
 
 #include "arch/generic/debugfaults.hh"
+#include "base/intmath.hh"
 #include "base/str.hh"
 #include "cpu/checker/cpu.hh"
 #include "cpu/o3/dyn_inst.hh"
@@ -54,7 +55,10 @@
 #include "debug/LSQUnit.hh"
 #include "debug/O3PipeView.hh"
 #include "mem/packet.hh"
+#include "mem/page_table.hh"
 #include "mem/request.hh"
+#include "sim/full_system.hh"
+#include "sim/process.hh"
 
 namespace gem5
 {
@@ -250,7 +254,13 @@ LSQUnit::init(CPU *cpu_ptr, IEW *iew_ptr, const BaseO3CPUParams &params,
 
     depCheckShift = params.LSQDepCheckShift;
     checkLoads = params.LSQCheckLoads;
+    valueReexec = params.loadValueReexec;
+    storeExecCount = 0;
+    snoopCount = 0;
     needsTSO = params.needsTSO;
+    writeBufferEntries = params.writeBufferEntries;
+    dvrLeadDistance = params.dvrLeadDistance;
+    dvrNestedRows = params.dvrNestedRows;
 
     resetState();
 }
@@ -272,6 +282,11 @@ LSQUnit::resetState()
     stalled = false;
 
     cacheBlockMask = ~(cpu->cacheLineSize() - 1);
+
+    writeBuffer.init(writeBufferEntries, cpu->cacheLineSize(), needsTSO);
+    wbLinesInFlight = 0;
+    wbFlush = false;
+    wbStalledLoad = nullptr;
 }
 
 std::string
@@ -302,12 +317,66 @@ LSQUnit::LSQUnitStats::LSQUnitStats(statistics::Group *parent)
       ADD_STAT(blockedByCache, statistics::units::Count::get(),
                "Number of times an access to memory failed due to the cache "
                "being blocked"),
+      ADD_STAT(wbStores, statistics::units::Count::get(),
+               "Number of committed stores written into the write buffer"),
+      ADD_STAT(wbCoalescedStores, statistics::units::Count::get(),
+               "Number of stores merged into a line already in the write "
+               "buffer"),
+      ADD_STAT(wbLineWrites, statistics::units::Count::get(),
+               "Number of lines written to the cache by the write buffer"),
+      ADD_STAT(wbForwLoads, statistics::units::Count::get(),
+               "Number of loads that had data forwarded from the write "
+               "buffer"),
+      ADD_STAT(wbPartialLoads, statistics::units::Count::get(),
+               "Number of loads that partially hit in the write buffer and "
+               "waited for it to drain"),
+      ADD_STAT(cacheLoads, statistics::units::Count::get(),
+               "Number of load packets sent to the cache"),
+      ADD_STAT(pairedLoads, statistics::units::Count::get(),
+               "Number of loads that shared the cache access of a load to "
+               "the same line"),
+      ADD_STAT(loadPairRate, statistics::units::Ratio::get(),
+               "Fraction of loads served by a paired access",
+               pairedLoads / (cacheLoads + pairedLoads)),
+      ADD_STAT(dvrLanes, statistics::units::Count::get(),
+               "Number of DVR lanes sent to the cache"),
+      ADD_STAT(dvrLanesSkipped, statistics::units::Count::get(),
+               "Number of DVR lanes already prefetched by an earlier "
+               "trigger"),
+      ADD_STAT(dvrLaneTranslations, statistics::units::Count::get(),
+               "Number of pages translated for DVR lanes"),
+      ADD_STAT(dvrLaneFaults, statistics::units::Count::get(),
+               "Number of DVR lanes dropped for a translation fault or a "
+               "protected page"),
+      ADD_STAT(nestedLoops, statistics::units::Count::get(),
+               "Number of inner loops DVR found to start from an outer "
+               "stride load's value"),
+      ADD_STAT(nestedRows, statistics::units::Count::get(),
+               "Number of outer loop lanes sent by nested DVR"),
+      ADD_STAT(nestedLanes, statistics::units::Count::get(),
+               "Number of inner loop lanes sent for future rows by nested "
+               "DVR"),
       ADD_STAT(loadToUse, "Distribution of cycle latency between the "
                 "first time a load is issued and its completion")
 {
     loadToUse
         .init(0, 299, 10)
         .flags(statistics::nozero);
+
+    wbStores.prereq(wbStores);
+    wbCoalescedStores.prereq(wbCoalescedStores);
+    wbLineWrites.prereq(wbLineWrites);
+    wbForwLoads.prereq(wbForwLoads);
+    wbPartialLoads.prereq(wbPartialLoads);
+    pairedLoads.prereq(pairedLoads);
+    loadPairRate.precision(4);
+    dvrLanes.prereq(dvrLanes);
+    dvrLanesSkipped.prereq(dvrLanesSkipped);
+    dvrLaneTranslations.prereq(dvrLaneTranslations);
+    dvrLaneFaults.prereq(dvrLaneFaults);
+    nestedLoops.prereq(nestedLoops);
+    nestedRows.prereq(nestedRows);
+    nestedLanes.prereq(nestedLanes);
 }
 
 void
@@ -323,6 +392,7 @@ LSQUnit::drainSanityCheck() const
         assert(!loadQueue[i].valid());
 
     assert(storesToWB == 0);
+    assert(writeBufferDrained());
     assert(!retryPkt);
 }
 
@@ -490,6 +560,15 @@ LSQUnit::checkSnoop(PacketPtr pkt)
         ld_inst->tcBase()->getIsaPtr()->handleLockedSnoopHit(ld_inst.get());
     }
 
+    // Without an LQ search, the line is remembered and loads that read
+    // it before this snoop are re-executed when they reach commit.
+    if (valueReexec) {
+        snoopedLines.emplace_back(++snoopCount, invalidate_addr);
+        if (snoopedLines.size() > snoopHistory)
+            snoopedLines.pop_front();
+        return;
+    }
+
     bool force_squash = false;
 
     while (++iter != loadQueue.end()) {
@@ -539,10 +618,45 @@ LSQUnit::checkSnoop(PacketPtr pkt)
     return;
 }
 
+bool
+LSQUnit::snoopedSince(const DynInstPtr &load_inst) const
+{
+    uint64_t stamp = load_inst->snoopStamp;
+    if (stamp == snoopCount)
+        return false;
+
+    // Snoops older than the history are no longer known.
+    if (snoopedLines.empty() || snoopedLines.front().first > stamp + 1)
+        return true;
+
+    // Only the physical address of a load's first page is known, so a
+    // page-crossing load is assumed to be snooped.
+    const Addr min_page_bytes = 4096;
+    if ((load_inst->effAddr % min_page_bytes) + load_inst->effSize >
+        min_page_bytes) {
+        return true;
+    }
+
+    Addr first_line = load_inst->physEffAddr & cacheBlockMask;
+    Addr last_line = (load_inst->physEffAddr + load_inst->effSize - 1) &
+        cacheBlockMask;
+    for (const auto &snoop : snoopedLines) {
+        if (snoop.first > stamp && snoop.second >= first_line &&
+            snoop.second <= last_line) {
+            return true;
+        }
+    }
+    return false;
+}
+
 Fault
 LSQUnit::checkViolations(typename LoadQueue::iterator& loadIt,
         const DynInstPtr& inst)
 {
+    // Loads that may have passed this store are found by value at commit.
+    if (valueReexec)
+        return NoFault;
+
     Addr inst_eff_addr1 = inst->effAddr >> depCheckShift;
     Addr inst_eff_addr2 = (inst->effAddr + inst->effSize - 1) >> depCheckShift;
 
@@ -642,12 +756,16 @@ LSQUnit::executeLoad(const DynInstPtr &inst)
 
     assert(!inst->isSquashed());
 
+    inst->storeStamp = storeExecCount;
+    inst->snoopStamp = snoopCount;
+
     load_fault = inst->initiateAcc();
 
     if (load_fault == NoFault && !inst->readMemAccPredicate()) {
         assert(inst->readPredicate());
         inst->setExecuted();
         inst->completeAcc(nullptr);
+        iewStage->verifyValuePrediction(inst);
         iewStage->instToCommit(inst);
         iewStage->activityThisCycle();
         return NoFault;
@@ -711,6 +829,8 @@ LSQUnit::executeStore(const DynInstPtr &store_inst)
 
     assert(!store_inst->isSquashed());
 
+    store_inst->storeStamp = ++storeExecCount;
+
     // Check the recently completed loads to see if any match this store's
     // address.  If so, then we have a memory ordering violation.
     typename LoadQueue::iterator loadIt = store_inst->lqIt;
@@ -872,6 +992,44 @@ LSQUnit::writebackStores()
         DynInstPtr inst = storeWBIt->instruction();
         LSQRequest* request = storeWBIt->request();
 
+        if (writeBuffer.enabled()) {
+            if (canBufferStore(inst, request)) {
+                Addr paddr = request->mainReq()->getPaddr();
+                if (!writeBuffer.canInsert(paddr, storeWBIt->size())) {
+                    DPRINTF(LSQUnit, "Write buffer full, draining before "
+                            "store [sn:%lli]\n", inst->seqNum);
+                    wbFlush = true;
+                    break;
+                }
+
+                bool merged = writeBuffer.insert(paddr,
+                        storeWBIt->isAllZeros() ? nullptr : storeWBIt->data(),
+                        storeWBIt->size());
+
+                DPRINTF(LSQUnit, "Store idx:%i PC:%s to Addr:%#x [sn:%lli] "
+                        "%s the write buffer\n", storeWBIt.idx(),
+                        inst->pcState(), paddr, inst->seqNum,
+                        merged ? "merged into" : "allocated in");
+
+                ++stats.wbStores;
+                if (merged)
+                    ++stats.wbCoalescedStores;
+
+                // The store is done as far as the SQ is concerned; the
+                // buffer makes it visible later.
+                storeWBIt->committed() = true;
+                completeStore(storeWBIt++);
+                continue;
+            } else if (!writeBufferDrained()) {
+                // Stores that bypass the buffer must not overtake the
+                // stores in it.
+                DPRINTF(LSQUnit, "Store [sn:%lli] waiting for the write "
+                        "buffer to drain\n", inst->seqNum);
+                wbFlush = true;
+                break;
+            }
+        }
+
         // Process store conditionals or store release after all previous
         // stores are completed
         if ((request->mainReq()->isLLSC() ||
@@ -960,6 +1118,99 @@ LSQUnit::writebackStores()
         }
     }
     assert(storesToWB >= 0);
+
+    if (!writeBuffer.empty())
+        drainWriteBuffer();
+}
+
+bool
+LSQUnit::canBufferStore(const DynInstPtr &inst, LSQRequest *request) const
+{
+    if (inst->isStoreConditional() || inst->isAtomic() ||
+        inst->inHtmTransactionalState() || request->isSplit()) {
+        return false;
+    }
+
+    const RequestPtr &req = request->mainReq();
+    return !req->isLLSC() && !req->isRelease() && !req->isUncacheable() &&
+        !req->isStrictlyOrdered() && !req->isLocalAccess() &&
+        !req->isCacheMaintenance() && !req->isMasked() && !req->isHTMCmd();
+}
+
+void
+LSQUnit::drainWriteBuffer()
+{
+    // Lines stay in the buffer while committed stores are still streaming
+    // out of the SQ, so that those stores get a chance to coalesce.
+    bool stores_waiting = storeWBIt.dereferenceable() &&
+        storeWBIt->valid() && storeWBIt->canWB();
+
+    while (!writeBuffer.empty() &&
+           ((!needsTSO) || (!storeInFlight && wbLinesInFlight == 0)) &&
+           !lsq->cacheBlocked() && lsq->cachePortAvailable(false)) {
+
+        if (stores_waiting && !wbFlush && !writeBuffer.full() &&
+            !writeBuffer.frontComplete()) {
+            break;
+        }
+
+        const StoreWriteBuffer::Entry &entry = writeBuffer.front();
+
+        RequestPtr req = std::make_shared<Request>(entry.lineAddr,
+                entry.data.size(), 0, cpu->dataRequestorId());
+        req->setContext(cpu->thread[lsqID]->contextId());
+        if (entry.validBytes != entry.data.size())
+            req->setByteEnable(entry.byteEnable);
+
+        PacketPtr pkt = Packet::createWrite(req);
+        pkt->allocate();
+        pkt->setData(entry.data.data());
+        pkt->senderState = new WriteBufferMarker(lsqID);
+
+        if (!dcachePort->sendTimingReq(pkt)) {
+            DPRINTF(LSQUnit, "D-Cache became blocked when writing back "
+                    "write buffer line %#x, will retry later\n",
+                    entry.lineAddr);
+            lsq->cacheBlocked(true);
+            ++stats.blockedByCache;
+            delete pkt->senderState;
+            delete pkt;
+            break;
+        }
+
+        DPRINTF(LSQUnit, "D-Cache: Writing back write buffer line %#x, "
+                "%i bytes from %i stores\n", entry.lineAddr,
+                entry.validBytes, entry.numStores);
+
+        lsq->cachePortBusy(false);
+        ++wbLinesInFlight;
+        ++stats.wbLineWrites;
+        writeBuffer.popFront();
+
+        // The line is now ordered ahead of any load the cache sees next.
+        if (wbStalledLoad) {
+            iewStage->replayMemInst(wbStalledLoad);
+            wbStalledLoad = nullptr;
+        }
+    }
+
+    if (writeBuffer.empty()) {
+        wbFlush = false;
+    } else {
+        // Keep ticking until the buffer has drained.
+        cpu->activityThisCycle();
+    }
+}
+
+void
+LSQUnit::completeWriteBufferLine(PacketPtr pkt)
+{
+    assert(wbLinesInFlight > 0);
+    --wbLinesInFlight;
+
+    DPRINTF(LSQUnit, "Write buffer line %#x written\n", pkt->getAddr());
+
+    cpu->wakeCPU();
 }
 
 void
@@ -997,6 +1248,8 @@ LSQUnit::squash(const InstSeqNum &squashed_num)
             DPRINTF(HtmCpu, ">> htmStarts (%d) : htmStops-- (%d)\n",
               htmStarts, htmStops);
         }
+        iewStage->releaseValuePrediction(loadQueue.back().instruction());
+
         // Clear the smart pointer to make sure it is decremented.
         loadQueue.back().instruction()->setSquashed();
         loadQueue.back().clear();
@@ -1155,6 +1408,7 @@ LSQUnit::writeback(const DynInstPtr &inst, PacketPtr pkt)
     if (inst->isSquashed()) {
         assert (!inst->isStore() || inst->isStoreConditional());
         ++stats.ignoredResponses;
+        iewStage->releaseValuePrediction(inst);
         return;
     }
 
@@ -1164,7 +1418,28 @@ LSQUnit::writeback(const DynInstPtr &inst, PacketPtr pkt)
         if (inst->fault == NoFault) {
             // Complete access to copy data to proper place.
             inst->completeAcc(pkt);
+
+            if (cpu->indirectPrefetcher.enabled())
+                cpu->indirectPrefetcher.loadCompleted(inst);
+
+            if (dvrNestedRows && inst->memData &&
+                inst->effSize <= sizeof(uint64_t) &&
+                cpu->isStridePC(inst->pcState().instAddr())) {
+                StrideValues &values =
+                    strideLoadValues[inst->pcState().instAddr()];
+                values.value[1] = values.value[0];
+                values.value[0] = readLaneValue(inst->memData,
+                                                inst->effSize);
+                values.count = std::min(values.count + 1, 2u);
+            }
+
+            // Check the loaded value against the one dependents may
+            // already have been woken with.
+            iewStage->verifyValuePrediction(inst);
+            iewStage->verifyMemRename(inst);
         } else {
+            iewStage->releaseValuePrediction(inst);
+
             // If the instruction has an outstanding fault, we cannot complete
             // the access as this discards the current fault.
 
@@ -1279,6 +1554,17 @@ LSQUnit::trySendPacket(bool isLoad, PacketPtr data_pkt)
 
     LSQRequest *request = dynamic_cast<LSQRequest*>(data_pkt->senderState);
 
+    // A load to a line already being read this cycle shares that access,
+    // and so needs neither a port nor a packet of its own.
+    if (isLoad && lsq->pairLoad(data_pkt)) {
+        ++stats.pairedLoads;
+        request->packetSent();
+        DPRINTF(LSQUnit, "Memory request (pkt: %s) from inst [sn:%llu] "
+                "paired\n", data_pkt->print(),
+                request->instruction()->seqNum);
+        return true;
+    }
+
     if (!lsq->cacheBlocked() &&
         lsq->cachePortAvailable(isLoad)) {
         if (!dcachePort->sendTimingReq(data_pkt)) {
@@ -1292,6 +1578,9 @@ LSQUnit::trySendPacket(bool isLoad, PacketPtr data_pkt)
     if (ret) {
         if (!isLoad) {
             isStoreBlocked = false;
+        } else {
+            ++stats.cacheLoads;
+            lsq->loadSent(data_pkt);
         }
         lsq->cachePortBusy(isLoad);
         request->packetSent();
@@ -1353,6 +1642,11 @@ LSQUnit::recvRetry()
         DPRINTF(LSQUnit, "Receiving retry: blocked store\n");
         writebackBlockedStore();
     }
+
+    if (!writeBuffer.empty()) {
+        DPRINTF(LSQUnit, "Receiving retry: write buffer\n");
+        drainWriteBuffer();
+    }
 }
 
 void
@@ -1421,8 +1715,17 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
     assert(!load_inst->isExecuted());
 
 //===========================DVR Discovery=======================================//
-    // stride 检测
-    if (request && request->mainReq()) {
+    // The IMP baseline trains on the same stride loads DVR starts from.
+    if (request && request->mainReq() && cpu->indirectPrefetcher.enabled()) {
+        Addr pc = load_inst->pcState().instAddr();
+        Addr addr = request->mainReq()->getVaddr();
+
+        strideDetector.checkStride(pc, addr);
+        int stride = cpu->isStridePC(pc) ?
+            strideDetector.getStrideValue(pc) : 0;
+        cpu->indirectPrefetcher.observeLoad(load_inst, addr, stride);
+    } else if (request && request->mainReq() && cpu->dvrRunahead()) {
+        // stride 检测, only when DVR is the runahead engine
         Addr pc = load_inst->pcState().instAddr();
         Addr addr = request->mainReq()->getVaddr();
         
@@ -1431,6 +1734,9 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
         
         // 检测 stride 模式，但只在不是向量化加载时进行
         if (!inVectorizedLoad) {
+            if (dvrNestedRows)
+                trainNested(load_inst, pc, addr);
+
             strideDetector.checkStride(pc, addr);
             
             // 检查是否是 stride load 且依赖链已经记录完成
@@ -1451,6 +1757,18 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
                     inVectorizedLoad = false;
                 }
             }
+
+            // An inner loop shorter than the lead distance ends before
+            // its lanes are of use, so run ahead across its outer loop.
+            if (dvrNestedRows && cpu->isStridePC(pc) &&
+                hasShortInnerLoop(pc)) {
+                int stride = strideDetector.getStrideValue(pc);
+                if (stride != 0) {
+                    inVectorizedLoad = true;
+                    executeNestedRunahead(load_inst, addr, stride);
+                    inVectorizedLoad = false;
+                }
+            }
         }
 
             // 对于依赖加载,检查是否有计算结果可用
@@ -1461,18 +1779,15 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
         if (!inDependentLoad && lsq->hasResults()) {
             // 使用计算结果
             const uint64_t* results = lsq->getComputedResults();
-            
-            // printf("DVR: Starting dependent load execution with %d results\n", lsq->numResults);
-            for (int i = 0; i < lsq->numResults; i++) {
-                // printf("DVR: Result %d: %#lx\n", i, results[i]);
-            }
 
             // 设置标志，表示正在执行加载
             inDependentLoad = true;
-            
-            //迭代执行dependent load
-            for (int i = 0; i < 32; i++) {
-                printf("DVR: Executing dependent load %d with address %#lx\n", i, results[i]);
+            lanePages.clear();
+
+            //迭代执行dependent load, one per lane result
+            DPRINTF(LSQUnit, "DVR: Executing %d dependent loads\n",
+                    lsq->numResults);
+            for (int i = 0; i < lsq->numResults; i++) {
                 executeDependentLoad(load_inst, results[i]);
             }
 
@@ -1695,6 +2010,14 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
                 // Don't need to do anything special for split loads.
                 ++stats.forwLoads;
 
+                // An exact forward of a whole store teaches the memory
+                // renaming predictor to link this pair at rename.
+                if (lsq->memRenamePred.enabled() && shift_amt == 0 &&
+                    store_size == request->mainReq()->getSize()) {
+                    trainMemRename(load_inst, store_it->instruction(),
+                                   store_it->data(), store_size);
+                }
+
                 return NoFault;
             } else if (
                     coverage == AddrRangeCoverage::PartialAddrRangeCoverage) {
@@ -1737,6 +2060,76 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
         }
     }
 
+    // Committed stores still in the write buffer are older than anything
+    // in the SQ, so check them only once the SQ had nothing to forward.
+    if (!writeBuffer.empty() && !load_inst->isDataPrefetch()) {
+        const RequestPtr &req = request->isSplit() ? request->req(0) :
+            request->mainReq();
+        bool plain_load = !request->isSplit() && !req->isLLSC() &&
+            !req->isHTMCmd() && !req->isMasked() &&
+            !load_inst->inHtmTransactionalState();
+
+        auto coverage = StoreWriteBuffer::Coverage::None;
+        if (plain_load) {
+            if (!load_inst->memData)
+                load_inst->memData = new uint8_t[req->getSize()];
+            coverage = writeBuffer.lookup(req->getPaddr(), req->getSize(),
+                                          load_inst->memData);
+        } else {
+            // Anything but a plain load waits for overlapping lines to
+            // drain rather than being forwarded to.
+            for (const auto &frag : request->_reqs) {
+                std::vector<uint8_t> scratch(frag->getSize());
+                if (writeBuffer.lookup(frag->getPaddr(), frag->getSize(),
+                        scratch.data()) !=
+                        StoreWriteBuffer::Coverage::None) {
+                    coverage = StoreWriteBuffer::Coverage::Partial;
+                    break;
+                }
+            }
+        }
+
+        if (coverage == StoreWriteBuffer::Coverage::Full) {
+            DPRINTF(LSQUnit, "Forwarding from the write buffer to load to "
+                    "addr %#x\n", req->getPaddr());
+
+            PacketPtr data_pkt = new Packet(req, MemCmd::ReadReq);
+            data_pkt->dataStatic(load_inst->memData);
+
+            if (request->isAnyOutstandingRequest()) {
+                assert(request->_numOutstandingPackets > 0);
+                request->discard();
+                load_entry.setRequest(nullptr);
+            }
+
+            WritebackEvent *wb = new WritebackEvent(load_inst, data_pkt,
+                    this);
+            cpu->schedule(wb, curTick());
+
+            ++stats.forwLoads;
+            ++stats.wbForwLoads;
+            return NoFault;
+        } else if (coverage == StoreWriteBuffer::Coverage::Partial) {
+            // Drain the buffer and retry the load once a line has left it.
+            wbFlush = true;
+            wbStalledLoad = load_inst;
+
+            iewStage->rescheduleMemInst(load_inst);
+            load_inst->clearIssued();
+            load_inst->effAddrValid(false);
+            ++stats.rescheduledLoads;
+            ++stats.wbPartialLoads;
+
+            DPRINTF(LSQUnit, "Load [sn:%lli] to addr %#x partially hit in "
+                    "the write buffer\n", load_inst->seqNum,
+                    req->getPaddr());
+
+            request->discard();
+            load_entry.setRequest(nullptr);
+            return NoFault;
+        }
+    }
+
     // If there's no forwarding case, then go access memory
     DPRINTF(LSQUnit, "Doing memory access for inst [sn:%lli] PC %s\n",
             load_inst->seqNum, load_inst->pcState());
@@ -1808,6 +2201,28 @@ LSQUnit::getLoadHeadSeqNum()
         return 0;
 }
 
+DynInstPtr
+LSQUnit::oldestLongLatencyLoad(Cycles latency)
+{
+    Tick threshold = cpu->cyclesToTicks(latency);
+
+    for (auto &entry : loadQueue) {
+        if (!entry.valid())
+            continue;
+
+        const DynInstPtr &inst = entry.instruction();
+        if (inst->isSquashed() || inst->isExecuted() ||
+            inst->firstIssue == -1 ||
+            curTick() - inst->firstIssue < threshold) {
+            continue;
+        }
+
+        return inst;
+    }
+
+    return nullptr;
+}
+
 InstSeqNum
 LSQUnit::getStoreHeadSeqNum()
 {
@@ -1817,6 +2232,31 @@ LSQUnit::getStoreHeadSeqNum()
         return 0;
 }
 
+void
+LSQUnit::trainMemRename(const DynInstPtr &load_inst,
+                        const DynInstPtr &store_inst, const char *data,
+                        int size)
+{
+    // Only a whole register can be shared; a narrower load would extend
+    // the value, which the register does not.
+    if (size != (int)sizeof(RegVal) || load_inst->numDestRegs() != 1 ||
+        !load_inst->destRegIdx(0).is(IntRegClass)) {
+        return;
+    }
+
+    // The data came from whichever source register holds the value.
+    RegVal value = readLaneValue((const uint8_t *)data, size);
+    for (int i = 0; i < store_inst->numSrcRegs(); i++) {
+        if (store_inst->srcRegIdx(i).is(IntRegClass) &&
+            cpu->getReg(store_inst->renamedSrcIdx(i),
+                        store_inst->threadNumber) == value) {
+            lsq->memRenamePred.train(load_inst->pcState().instAddr(),
+                                     store_inst->pcState().instAddr(), i);
+            return;
+        }
+    }
+}
+
 //===========================DVR Discovery=======================================//
 void
 LSQUnit::StrideDetector::checkStride(Addr pc, Addr addr)
@@ -1896,6 +2336,77 @@ LSQUnit::StrideDetector::getStrideValue(Addr pc) const
 }
 //===========================DVR Discovery=======================================//
 
+//===========================DVR Lanes=======================================//
+int
+LSQUnit::firstNewLane(const std::map<Addr, RunaheadFrontier> &frontiers,
+                      Addr pc, Addr base_addr, int stride, int num_lanes)
+{
+    // Lanes up to the frontier were sent by an earlier trigger. A frontier
+    // behind this load, past the lead distance or with another stride
+    // belongs to an earlier run of the loop.
+    auto frontier = frontiers.find(pc);
+    if (frontier != frontiers.end() &&
+        frontier->second.stride == stride) {
+        int64_t dist = frontier->second.addr - base_addr;
+        if (dist % stride == 0 && dist / stride > 0 &&
+            dist / stride < num_lanes) {
+            return dist / stride + 1;
+        }
+    }
+    return 1;
+}
+
+bool
+LSQUnit::translateLane(const RequestPtr &req, ThreadID tid)
+{
+    Addr vaddr = req->getVaddr();
+    Addr vpage = roundDown(vaddr, dvrPageBytes);
+
+    // a lane split across two pages would need both translated
+    if (roundDown(vaddr + req->getSize() - 1, dvrPageBytes) != vpage) {
+        return false;
+    }
+
+    auto page = lanePages.find(vpage);
+    if (page == lanePages.end()) {
+        bool usable;
+        if (FullSystem) {
+            // A functional translation returns its fault instead of
+            // raising it, and the page's attributes come back on the
+            // request.
+            Fault fault = cpu->mmu->translateFunctional(
+                    req, cpu->tcBase(tid), BaseMMU::Read);
+            usable = fault == NoFault && !req->isUncacheable() &&
+                !req->isStrictlyOrdered() && !req->isLocalAccess();
+        } else {
+            // In SE mode the MMU fixes up a missing page, for instance by
+            // growing the stack, so only look in the process page table.
+            EmulationPageTable *p_table =
+                cpu->tcBase(tid)->getProcessPtr()->pTable;
+            const EmulationPageTable::Entry *pte = p_table->lookup(vaddr);
+            usable = pte && !(pte->flags & EmulationPageTable::Uncacheable);
+            if (usable)
+                req->setPaddr(pte->paddr + p_table->pageOffset(vaddr));
+        }
+
+        ++stats.dvrLaneTranslations;
+        DPRINTF(LSQUnit, "DVR lane page %#x %s\n", vpage,
+                usable ? "translated" : "dropped");
+
+        page = lanePages.emplace(vpage, usable ?
+                roundDown(req->getPaddr(), dvrPageBytes) : MaxAddr).first;
+    }
+
+    if (page->second == MaxAddr) {
+        ++stats.dvrLaneFaults;
+        return false;
+    }
+
+    req->setPaddr(page->second + (vaddr - vpage));
+    return true;
+}
+//===========================DVR Lanes=======================================//
+
 //===========================DVR Vectorized=======================================//
 void
 LSQUnit::executeVectorizedStrideLoad(const DynInstPtr &inst, Addr baseAddr, int stride)
@@ -1927,19 +2438,45 @@ LSQUnit::executeVectorizedStrideLoad(const DynInstPtr &inst, Addr baseAddr, int
     printf("Requestor ID: %d\n", inst->requestorId());
     printf("\n");
     
-    // send 4 load requests to the cache
-    const int vectorSize = 33;  
-    
-    // allocate a buffer for the vector load to store all results
-    uint8_t *vectorData = new uint8_t[inst->effSize * vectorSize];
-    
+    // lanes reach dvrLeadDistance iterations past this one
+    const int vectorSize = dvrLeadDistance + 1;
+
     // 获取该 PC 并传递给 LSQ
     Addr pc = inst->pcState().instAddr();
-    cpu->getLSQ().setCurrentStridePC(pc);
-    
-    for (int i = 1; i < vectorSize; i++) {
+
+    int first_lane = firstNewLane(runaheadFrontier, pc, baseAddr, stride,
+                                  vectorSize);
+    stats.dvrLanesSkipped += first_lane - 1;
+
+    if (first_lane == vectorSize) {
+        DPRINTF(LSQUnit, "Runahead frontier of PC %#x already %i "
+                "iterations ahead\n", pc, vectorSize - 1);
+        return;
+    }
+
+    // allocate a buffer for the vector load to store all results
+    uint8_t *vectorData = new uint8_t[inst->effSize * vectorSize];
+
+    // Lanes are generated in virtual space and share a translation per
+    // page; the base load's page is already translated.
+    lanePages.clear();
+    lanePages[roundDown(baseAddr, dvrPageBytes)] =
+        roundDown(basePhysAddr, dvrPageBytes);
+
+    for (int i = first_lane; i < vectorSize; i++) {
+        Addr vaddr = baseAddr + i * stride;
+
+        RequestPtr req = std::make_shared<Request>(vaddr, inst->effSize,
+                origReq->getFlags(), inst->requestorId(), pc,
+                inst->contextId());
+        req->taskId(cpu->taskId());
+
+        if (!translateLane(req, inst->threadNumber)) {
+            continue;
+        }
+
         // calculate the physical address
-        Addr paddr = basePhysAddr + i * stride;
+        Addr paddr = req->getPaddr();
         
         printf("Request %d:\n", i);
         printf("Physical Address: 0x%lx\n", paddr);
@@ -1947,25 +2484,26 @@ LSQUnit::executeVectorizedStrideLoad(const DynInstPtr &inst, Addr baseAddr, int
         // calculate the data buffer offset for this request
         uint8_t *dataPtr = vectorData + (i * inst->effSize);
         
-        // clone a new request from the original request, only modify the physical address
-        RequestPtr req = std::make_shared<Request>(*origReq);
-        req->setPaddr(paddr);
-        
         // create a packet
         PacketPtr data_pkt = new Packet(req, MemCmd::DVRReadReq);
         data_pkt->dataStatic(dataPtr);
 
         // set the vector load marker
-        data_pkt->senderState = new VectorMarker();
+        data_pkt->senderState = new VectorMarker(pc);
 
         // send the packet to the cache directly
         bool sent = dcachePort->sendTimingReq(data_pkt);
 
         if (sent) {
             printf("  Vector load request %d sent directly to cache\n", i);
+            runaheadFrontier[pc] = {baseAddr + i * stride, stride};
+            ++stats.dvrLanes;
         } else {
+            // the next trigger resumes from the last lane sent
             printf("  Vector load request %d failed to send, cache blocked\n", i);
+            delete data_pkt->senderState;
             delete data_pkt;
+            break;
         }
     }
     
@@ -2002,27 +2540,6 @@ LSQUnit::executeDependentLoad(const DynInstPtr &inst, Addr baseAddr)
         return;
     }
     
-    // 修改地址范围检查 - 检查地址是否在合理的用户空间范围内
-    // 用户空间地址通常在 0x400000 到 0x7fffffffffffff 之间
-    //0x7ffffffffffffee8
-    //0x7fffffffffffff00ULL
-    //0x7ffffffffffebf98
-    if (baseAddr > 0x7fffffffffffff00ULL) {
-        printf("DVR: Warning - Address %#lx is outside valid user space range, skipping\n", baseAddr);
-        return;
-    }
-    
-    // allocate a buffer for the dependent load to store result
-    uint8_t *DependentData = new uint8_t[inst->effSize];
-    
-    // calculate the physical address，传入正确的大小
-    Addr paddr = translateVirtualToPhysical(baseAddr, inst->effSize);
-    
-    if (paddr == 0) {
-        printf("DVR: Warning - Address translation failed for vaddr %#lx\n", baseAddr);
-        delete[] DependentData;  // 只在地址转换失败时删除
-        return;
-    }
 
     // printf("Physical Address: 0x%lx\n", paddr);
     
@@ -2038,8 +2555,16 @@ LSQUnit::executeDependentLoad(const DynInstPtr &inst, Addr baseAddr)
         inst->contextId()          // 上下文ID
     );
     
-    // 设置物理地址
-    req->setPaddr(paddr);
+    // An address computed from a lane may be anywhere; one that does not
+    // translate to ordinary memory is dropped.
+    if (!translateLane(req, inst->threadNumber)) {
+        DPRINTF(LSQUnit, "DVR: dropping lane at vaddr %#x, it does not "
+                "translate\n", baseAddr);
+        return;
+    }
+
+    // allocate a buffer for the dependent load to store result
+    uint8_t *DependentData = new uint8_t[inst->effSize];
     
     // printf("DVR: Created request with size: %d bytes\n", req->getSize());  // 添加调试信息
         
@@ -2071,51 +2596,181 @@ LSQUnit::executeDependentLoad(const DynInstPtr &inst, Addr baseAddr)
 
 //===========================DVR Vectorized=======================================//
 
-//===========================DVR Vectorized=======================================//
-Addr 
-LSQUnit::translateVirtualToPhysical(Addr vaddr, size_t size) 
+//===========================DVR Nested=======================================//
+void
+LSQUnit::trainNested(const DynInstPtr &inst, Addr pc, Addr addr)
 {
-    // 检查地址对齐
-    if (vaddr % size != 0) {
-        printf("DVR: Warning - Unaligned address %#lx for size %zu\n", vaddr, size);
-        // 对齐地址到size边界
-        vaddr = (vaddr / size) * size;
-        printf("DVR: Aligned address to %#lx\n", vaddr);
+    StrideRun &run = strideRuns[pc];
+    int64_t diff = addr - run.lastAddr;
+
+    if (run.length == 0) {
+        run.lastAddr = addr;
+        run.length = 1;
+        return;
     }
-    
-    // 获取当前线程上下文
-    gem5::ThreadContext *tc = cpu->tcBase(0);
-    
-    // 创建请求
-    RequestPtr req = std::make_shared<Request>(
-        vaddr,                     // 虚拟地址
-        size,                         // 大小(bytes)
-        MemCmd::ReadReq,          // 使用 MemCmd::ReadReq
-        cpu->dataRequestorId(),   
-        0,                        
-        tc->contextId()           
-    );
 
-    // 使用 translate 而不是 translateAddress
-    Addr paddr;
-    gem5::BaseMMU::Mode mode = gem5::BaseMMU::Read;
-    Process *p = tc->getProcessPtr();
-    TestTranslation *trans = new TestTranslation(this);
-    
-    // 进行地址转换
-    cpu->mmu->translateTiming(req, tc, trans, mode);
-
-    uint64_t Trans_finish_flag = req->getTrans_finish_flag();
-    if (Trans_finish_flag == 1) {
-        paddr = req->getPaddr();
-        printf("Address translation: vaddr %#lx -> paddr %#lx (size: %zu)\n", vaddr, paddr, size);
-        req->setTrans_finish_flag(0);
-        return paddr;
-    } else {
-        printf("Address translation failed for vaddr %#lx\n", vaddr);
-        return 0;
+    if (diff == 0)
+        return;
+
+    // A stride is the step seen twice in a row; any other step ends the
+    // run and starts a new one.
+    if (diff == run.lastDiff)
+        run.stride = diff;
+    run.lastDiff = diff;
+    run.lastAddr = addr;
+
+    if (diff == run.stride) {
+        ++run.length;
+        return;
+    }
+
+    run.avgLength = run.avgLength ?
+        (3 * run.avgLength + run.length) / 4 : run.length;
+    run.length = 1;
+
+    // Only stride loads can be inner loops. Other loads, such as the
+    // indirect accesses of the inner loop body, break stride every time.
+    if (run.stride == 0 || !cpu->isStridePC(pc))
+        return;
+
+    // See whether the run starts at an address given by the value of an
+    // outer stride load, in this iteration of it or the one before.
+    for (auto &[outer_pc, values] : strideLoadValues) {
+        if (outer_pc == pc)
+            continue;
+
+        NestedLoop &loop = nestedLoops[{outer_pc, pc}];
+        loop.innerStride = run.stride;
+        loop.innerSize = inst->effSize;
+
+        bool matched = false;
+        for (unsigned lag = 0; lag < values.count; lag++) {
+            if (loop.fits[lag].observe(values.value[lag], addr)) {
+                matched = true;
+                if (!loop.confirmed) {
+                    DPRINTF(LSQUnit, "Nested DVR: inner PC %#x starts at "
+                            "%#x * value of outer PC %#x + %#x\n", pc,
+                            loop.fits[lag].scale, outer_pc,
+                            loop.fits[lag].offset);
+                    ++stats.nestedLoops;
+                }
+                loop.confirmed = true;
+                loop.scale = loop.fits[lag].scale;
+                loop.base = loop.fits[lag].offset;
+                break;
+            }
+        }
+
+        if (!matched)
+            loop.confirmed = false;
     }
 }
-//===========================DVR Vectorized=======================================//
+
+bool
+LSQUnit::hasShortInnerLoop(Addr outer_pc)
+{
+    for (auto it = nestedLoops.lower_bound({outer_pc, 0});
+         it != nestedLoops.end() && it->first.first == outer_pc; ++it) {
+        if (it->second.confirmed &&
+            strideRuns[it->first.second].avgLength < dvrLeadDistance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+LSQUnit::executeNestedRunahead(const DynInstPtr &inst, Addr baseAddr,
+                               int stride)
+{
+    Addr pc = inst->pcState().instAddr();
+    int num_lanes = dvrNestedRows + 1;
+
+    int first_lane = firstNewLane(nestedFrontier, pc, baseAddr, stride,
+                                  num_lanes);
+    stats.dvrLanesSkipped += first_lane - 1;
+
+    lanePages.clear();
+
+    for (int i = first_lane; i < num_lanes; i++) {
+        RequestPtr req = std::make_shared<Request>(baseAddr + i * stride,
+                inst->effSize, 0, inst->requestorId(), pc,
+                inst->contextId());
+        req->taskId(cpu->taskId());
+
+        if (!translateLane(req, inst->threadNumber))
+            continue;
+
+        PacketPtr pkt = new Packet(req, MemCmd::DVRReadReq);
+        pkt->allocate();
+        pkt->senderState = new NestedMarker(inst->threadNumber, pc);
+
+        if (!dcachePort->sendTimingReq(pkt)) {
+            // the next trigger resumes from the last lane sent
+            delete pkt->senderState;
+            delete pkt;
+            break;
+        }
+
+        nestedFrontier[pc] = {baseAddr + i * stride, stride};
+        ++stats.nestedRows;
+    }
+
+    DPRINTF(LSQUnit, "Nested DVR: outer PC %#x sent rows %i to %i\n", pc,
+            first_lane, num_lanes - 1);
+}
+
+void
+LSQUnit::nestedRowArrived(Addr outer_pc, PacketPtr pkt)
+{
+    if (pkt->getSize() > sizeof(uint64_t))
+        return;
+
+    uint64_t value = readLaneValue(pkt->getConstPtr<uint8_t>(),
+                                   pkt->getSize());
+    gem5::ThreadContext *tc = cpu->tcBase(lsqID);
+
+    for (auto it = nestedLoops.lower_bound({outer_pc, 0});
+         it != nestedLoops.end() && it->first.first == outer_pc; ++it) {
+        Addr inner_pc = it->first.second;
+        const NestedLoop &loop = it->second;
+        unsigned avg_length = strideRuns[inner_pc].avgLength;
+        if (!loop.confirmed || avg_length >= dvrLeadDistance)
+            continue;
+
+        // The row is as long as the inner loop's recent runs, and its
+        // lanes run through the inner stride load's chain like any other.
+        Addr start = value * loop.scale + loop.base;
+
+        lanePages.clear();
+
+        for (unsigned j = 0; j < avg_length; j++) {
+            RequestPtr req = std::make_shared<Request>(
+                    start + j * loop.innerStride, loop.innerSize, 0,
+                    cpu->dataRequestorId(), inner_pc, tc->contextId());
+            req->taskId(cpu->taskId());
+
+            if (!translateLane(req, lsqID))
+                continue;
+
+            PacketPtr data_pkt = new Packet(req, MemCmd::DVRReadReq);
+            data_pkt->allocate();
+            data_pkt->senderState = new VectorMarker(inner_pc);
+
+            if (!dcachePort->sendTimingReq(data_pkt)) {
+                delete data_pkt->senderState;
+                delete data_pkt;
+                return;
+            }
+
+            ++stats.nestedLanes;
+        }
+
+        DPRINTF(LSQUnit, "Nested DVR: row at %#x for inner PC %#x\n",
+                start, inner_pc);
+    }
+}
+//===========================DVR Nested=======================================//
+
 } // namespace o3
 } // namespace gem5
@@ -44,6 +44,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <deque>
 #include <map>
 #include <memory>
 #include <queue>
@@ -57,7 +58,9 @@
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/lane_value.hh"
 #include "cpu/o3/lsq.hh"
+#include "cpu/o3/write_buffer.hh"
 #include "cpu/timebuf.hh"
 #include "debug/HtmCpu.hh"
 #include "debug/LSQUnit.hh"
@@ -292,6 +295,14 @@ class LSQUnit
     /** Writes back stores. */
     void writebackStores();
 
+    /** Handles the response to a line written back from the store write
+     * buffer. */
+    void completeWriteBufferLine(PacketPtr pkt);
+
+    /** Returns if the store write buffer has nothing left to write. */
+    bool writeBufferDrained() const
+    { return writeBuffer.empty() && wbLinesInFlight == 0; }
+
     /** Completes the data access that has been returned from the
      * memory system. */
     void completeDataAccess(PacketPtr pkt);
@@ -357,11 +368,19 @@ class LSQUnit
     unsigned getCount() { return loadQueue.size() + storeQueue.size(); }
 
     /** Returns if there are any stores to writeback. */
-    bool hasStoresToWB() { return storesToWB; }
+    bool hasStoresToWB() { return storesToWB || !writeBufferDrained(); }
 
     /** Returns the number of stores to writeback. */
     int numStoresToWB() { return storesToWB; }
 
+    /** Returns the number of invalidations snooped so far. */
+    uint64_t numSnoops() const { return snoopCount; }
+
+    /** Returns whether an invalidation of a line a load read may have
+     * been snooped since it executed.
+     */
+    bool snoopedSince(const DynInstPtr &load_inst) const;
+
     /** Returns if the LSQ unit will writeback on this cycle. */
     bool
     willWB()
@@ -378,12 +397,16 @@ class LSQUnit
 
     unsigned int cacheLineSize();
 
-    /** 
-     * translate virtual address to physical address
-     * @param vaddr the virtual address to translate
-     * @return the translated physical address, if translation fails return 0
+    /**
+     * Translates a DVR lane without raising faults or any other side
+     * effect. Pages are translated at most once per burst of lanes; a
+     * lane in a page that faulted, or would need the process to map it,
+     * or that maps uncacheable or strictly ordered memory, is dropped.
+     * @param req The lane's request, whose physical address is set.
+     * @param tid The thread the lane runs ahead for.
+     * @return Whether the lane may be sent.
      */
-    Addr translateVirtualToPhysical(Addr vaddr, size_t size);
+    bool translateLane(const RequestPtr &req, ThreadID tid);
 
   private:
     /** Reset the LSQ state */
@@ -401,6 +424,14 @@ class LSQUnit
     /** Handles completing the send of a store to memory. */
     void storePostSend();
 
+    /** Returns whether a committed store may be written into the store
+     * write buffer rather than sent to the cache on its own. */
+    bool canBufferStore(const DynInstPtr &inst, LSQRequest *request) const;
+
+    /** Sends the oldest store write buffer lines to the cache, as far as
+     * the drain policy and the cache ports allow. */
+    void drainWriteBuffer();
+
   public:
     /** Attempts to send a packet to the cache.
      * Check if there are ports available. Return true if
@@ -483,6 +514,25 @@ class LSQUnit
     /** Should loads be checked for dependency issues */
     bool checkLoads;
 
+    /** Whether ordering is checked by re-executing loads at commit
+     * instead of searching the LQ.
+     */
+    bool valueReexec;
+
+    /** Number of stores executed, stamped on each load and store. */
+    uint64_t storeExecCount;
+
+    /** Number of invalidations snooped, stamped on each load. */
+    uint64_t snoopCount;
+
+    /** Recent snooped invalidations, oldest first, as the snoop count
+     * after each one and the line it invalidated.
+     */
+    std::deque<std::pair<uint64_t, Addr>> snoopedLines;
+
+    /** Number of snooped lines remembered for load re-execution. */
+    static constexpr size_t snoopHistory = 32;
+
     /** The number of store instructions in the SQ waiting to writeback. */
     int storesToWB;
 
@@ -528,6 +578,23 @@ class LSQUnit
     /** Flag for memory model. */
     bool needsTSO;
 
+    /** Post-commit buffer that coalesces committed stores by line. */
+    StoreWriteBuffer writeBuffer;
+
+    /** Number of store write buffer entries; 0 disables the buffer. */
+    unsigned writeBufferEntries;
+
+    /** Number of write buffer lines sent but not yet acknowledged. */
+    int wbLinesInFlight;
+
+    /** Whether the write buffer must drain regardless of coalescing, as
+     * a store or load is waiting on it. */
+    bool wbFlush;
+
+    /** A load that partially hit in the write buffer and is waiting for
+     * the line to drain. */
+    DynInstPtr wbStalledLoad;
+
     // 在 LSQUnit 类中修改 StrideDetector 的声明
     class StrideDetector
     {
@@ -550,28 +617,88 @@ class LSQUnit
         int getStrideValue(Addr pc) const;
     };
 
-    class TestTranslation : public BaseMMU::Translation
+    // 在 LSQUnit 类的构造函数中添加 strideDetector 的初始化
+    StrideDetector strideDetector;
+
+    /** Furthest lane DVR has prefetched for a stride load. */
+    struct RunaheadFrontier
     {
-      protected:
-        LSQUnit *lsqUnit;
+        Addr addr;
+        int stride;
+    };
 
-      public:
-        TestTranslation(LSQUnit *_lsqUnit) : lsqUnit(_lsqUnit) {}
+    /** Runahead frontier of each stride PC, so that a trigger only sends
+     * the iterations the previous ones have not reached.
+     */
+    std::map<Addr, RunaheadFrontier> runaheadFrontier;
 
-        void markDelayed() {}
+    /** Runahead frontier of the outer lanes nested DVR sends for each
+     * outer stride PC. Kept apart from runaheadFrontier as both run from
+     * the same trigger with different lead distances.
+     */
+    std::map<Addr, RunaheadFrontier> nestedFrontier;
 
-        void
-        finish(const Fault &fault, const RequestPtr &req,
-            gem5::ThreadContext *tc, BaseMMU::Mode mode)
-        {
-            assert(mode == BaseMMU::Read);
-            // lsqUnit->finishTestTranslation(fault, req);
-            delete this;
-        }
+    /** Number of iterations ahead of a stride load DVR lanes reach. */
+    unsigned dvrLeadDistance;
+
+    /** Number of outer iterations nested DVR runs ahead; 0 disables
+     * nested runahead.
+     */
+    unsigned dvrNestedRows;
+
+    /** Current run of a load's addresses along one stride. */
+    struct StrideRun
+    {
+        Addr lastAddr = 0;
+        int64_t lastDiff = 0;
+        int64_t stride = 0;
+        unsigned length = 0;
+        /** Moving average of the length of the load's past runs. */
+        unsigned avgLength = 0;
     };
 
-    // 在 LSQUnit 类的构造函数中添加 strideDetector 的初始化
-    StrideDetector strideDetector;
+    /** Stride runs of each load PC, used to find short inner loops. */
+    std::map<Addr, StrideRun> strideRuns;
+
+    /** Last two values loaded by a stride load, newest first. */
+    struct StrideValues
+    {
+        uint64_t value[2] = {0, 0};
+        unsigned count = 0;
+    };
+
+    /** Recent values of each stride load, candidate outer loop bounds. */
+    std::map<Addr, StrideValues> strideLoadValues;
+
+    /** An inner stride loop whose runs start at value * scale + base of
+     * an outer stride load's value, in the same or the previous outer
+     * iteration.
+     */
+    struct NestedLoop
+    {
+        int64_t innerStride = 0;
+        unsigned innerSize = 0;
+        /** Fits for the current and the previous outer value. */
+        AffineFit fits[2];
+        bool confirmed = false;
+        uint64_t scale = 0;
+        uint64_t base = 0;
+    };
+
+    /** Nested loops, keyed by the PCs of their outer and inner stride
+     * loads, so inner loads of one outer loop are fit apart.
+     */
+    std::map<std::pair<Addr, Addr>, NestedLoop> nestedLoops;
+
+    /** Granularity at which DVR lanes reuse a translation: the smallest
+     * page size, so larger pages are only translated more often.
+     */
+    static constexpr Addr dvrPageBytes = 4096;
+
+    /** Pages translated in the current burst of DVR lanes, mapped to
+     * their physical page, or MaxAddr if the lanes in them are dropped.
+     */
+    std::map<Addr, Addr> lanePages;
 
   protected:
     // Will also need how many read/write ports the Dcache has.  Or keep track
@@ -603,6 +730,56 @@ class LSQUnit
         /** Number of times the LSQ is blocked due to the cache. */
         statistics::Scalar blockedByCache;
 
+        /** Number of committed stores written into the write buffer. */
+        statistics::Scalar wbStores;
+
+        /** Number of those stores that merged into an existing line. */
+        statistics::Scalar wbCoalescedStores;
+
+        /** Number of lines written to the cache by the write buffer. */
+        statistics::Scalar wbLineWrites;
+
+        /** Number of loads that had data forwarded from the write
+         * buffer. */
+        statistics::Scalar wbForwLoads;
+
+        /** Number of loads that partially hit in the write buffer and
+         * had to wait for it to drain. */
+        statistics::Scalar wbPartialLoads;
+
+        /** Number of load packets sent to the cache. */
+        statistics::Scalar cacheLoads;
+
+        /** Number of loads that shared another load's cache access. */
+        statistics::Scalar pairedLoads;
+
+        /** Fraction of loads that shared another load's access. */
+        statistics::Formula loadPairRate;
+
+        /** Number of DVR lanes sent to the cache. */
+        statistics::Scalar dvrLanes;
+
+        /** Number of DVR lanes not sent because an earlier trigger of the
+         * same stride load had already prefetched them. */
+        statistics::Scalar dvrLanesSkipped;
+
+        /** Number of pages translated for DVR lanes. */
+        statistics::Scalar dvrLaneTranslations;
+
+        /** Number of DVR lanes dropped for a translation fault or for
+         * mapping memory they may not access speculatively. */
+        statistics::Scalar dvrLaneFaults;
+
+        /** Number of inner loops found to start from an outer stride
+         * load's value. */
+        statistics::Scalar nestedLoops;
+
+        /** Number of outer loop lanes sent by nested DVR. */
+        statistics::Scalar nestedRows;
+
+        /** Number of inner loop lanes sent for future rows. */
+        statistics::Scalar nestedLanes;
+
         /** Distribution of cycle latency between the first time a load
          * is issued and its completion */
         statistics::Distribution loadToUse;
@@ -621,6 +798,19 @@ class LSQUnit
     /** Returns the sequence number of the head load instruction. */
     InstSeqNum getLoadHeadSeqNum();
 
+    /** Returns the oldest load that has been waiting on memory for at
+     * least the given latency, or nullptr if there is none.
+     */
+    DynInstPtr oldestLongLatencyLoad(Cycles latency);
+
+    /** Teaches the memory renaming predictor that a store forwarded all
+     * of a load's data, if the load reads back one of its source
+     * registers whole.
+     */
+    void trainMemRename(const DynInstPtr &load_inst,
+                        const DynInstPtr &store_inst, const char *data,
+                        int size);
+
     /** Returns the index of the head store instruction. */
     int getStoreHead() { return storeQueue.head(); }
     /** Returns the sequence number of the head store instruction. */
@@ -638,6 +828,34 @@ class LSQUnit
 
     void executeDependentLoad(const DynInstPtr &inst, Addr baseAddr);
 
+    /** Sends the value of a future outer loop lane to start a row of
+     * inner loop lanes, if its nested loop is still confirmed.
+     */
+    void nestedRowArrived(Addr outer_pc, PacketPtr pkt);
+
+  private:
+    /** Returns the first lane of a stride load past its frontier in
+     * frontiers, or 1 if the frontier is of an earlier run of its loop.
+     */
+    int firstNewLane(const std::map<Addr, RunaheadFrontier> &frontiers,
+                     Addr pc, Addr base_addr, int stride, int num_lanes);
+
+    /** Tracks a load's stride runs and, at the start of a run, matches
+     * its address against the values of outer stride loads.
+     */
+    void trainNested(const DynInstPtr &inst, Addr pc, Addr addr);
+
+    /** Whether an outer stride load has a confirmed inner loop shorter
+     * than the lead distance.
+     */
+    bool hasShortInnerLoop(Addr outer_pc);
+
+    /** Sends lanes for future iterations of an outer loop whose inner
+     * loop is too short for its own lanes to run ahead.
+     */
+    void executeNestedRunahead(const DynInstPtr &inst, Addr baseAddr,
+                               int stride);
+
     // 在 LSQUnit 类的私有部分添加
     private:
         // 标志，表示当前是否正在执行向量化加载
@@ -0,0 +1,49 @@
+#include "cpu/o3/mem_dep_pred.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+ConservativeMemDepPred::insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                                    ThreadID tid)
+{
+    storeList[store_seq_num] = tid;
+}
+
+void
+ConservativeMemDepPred::checkInst(Addr PC, ThreadID tid,
+                                  std::vector<InstSeqNum> &producers)
+{
+    // Instructions are checked in program order before they are inserted,
+    // so every store of the thread still in the list is older.
+    for (const auto &store : storeList) {
+        if (store.second == tid)
+            producers.push_back(store.first);
+    }
+}
+
+void
+ConservativeMemDepPred::issued(Addr issued_PC, InstSeqNum issued_seq_num,
+                               bool is_store)
+{
+    if (is_store)
+        storeList.erase(issued_seq_num);
+}
+
+void
+ConservativeMemDepPred::squash(InstSeqNum squashed_num, ThreadID tid)
+{
+    auto store_it = storeList.upper_bound(squashed_num);
+    while (store_it != storeList.end()) {
+        if (store_it->second == tid)
+            store_it = storeList.erase(store_it);
+        else
+            ++store_it;
+    }
+}
+
+} // namespace o3
+} // namespace gem5
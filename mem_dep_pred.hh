@@ -0,0 +1,115 @@
+#ifndef __CPU_O3_MEM_DEP_PRED_HH__
+#define __CPU_O3_MEM_DEP_PRED_HH__
+
+#include <map>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Interface of the memory dependence predictors used by MemDepUnit. A
+ * predictor is told about stores as they enter the IQ and about ordering
+ * violations, and is asked which in-flight stores a new memory
+ * instruction should wait on.
+ */
+class MemDepPredictor
+{
+  public:
+    virtual ~MemDepPredictor() = default;
+
+    /** Records a memory ordering violation between the younger load
+     * and the older store.
+     */
+    virtual void violation(Addr store_PC, InstSeqNum store_seq_num,
+                           Addr load_PC, InstSeqNum load_seq_num,
+                           ThreadID tid) = 0;
+
+    /** Inserts a store into the predictor. */
+    virtual void insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                             ThreadID tid) = 0;
+
+    /** Checks which stores the instruction with the given PC depends
+     * upon, appending their sequence numbers to producers.
+     */
+    virtual void checkInst(Addr PC, ThreadID tid,
+                           std::vector<InstSeqNum> &producers) = 0;
+
+    /** Records this PC/sequence number as issued. */
+    virtual void issued(Addr issued_PC, InstSeqNum issued_seq_num,
+                        bool is_store) = 0;
+
+    /** Squashes for a specific thread until the given sequence number. */
+    virtual void squash(InstSeqNum squashed_num, ThreadID tid) = 0;
+
+    /** Resets all state. */
+    virtual void clear() = 0;
+};
+
+/**
+ * Predicts every load to depend on all older stores that have not yet
+ * issued, so no ordering violation can occur. Meant as a lower bound
+ * for dependence prediction studies.
+ */
+class ConservativeMemDepPred : public MemDepPredictor
+{
+  public:
+    void violation(Addr store_PC, InstSeqNum store_seq_num,
+                   Addr load_PC, InstSeqNum load_seq_num,
+                   ThreadID tid) override {}
+
+    void insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                     ThreadID tid) override;
+
+    void checkInst(Addr PC, ThreadID tid,
+                   std::vector<InstSeqNum> &producers) override;
+
+    void issued(Addr issued_PC, InstSeqNum issued_seq_num,
+                bool is_store) override;
+
+    void squash(InstSeqNum squashed_num, ThreadID tid) override;
+
+    void clear() override { storeList.clear(); }
+
+  private:
+    /** Stores that have been inserted but not yet issued or squashed,
+     * mapped to their thread.
+     */
+    std::map<InstSeqNum, ThreadID> storeList;
+};
+
+/**
+ * Never predicts a dependence, so loads issue as soon as their operands
+ * are ready. Meant as an upper bound on the cost of ordering violations.
+ */
+class SpeculativeMemDepPred : public MemDepPredictor
+{
+  public:
+    void violation(Addr store_PC, InstSeqNum store_seq_num,
+                   Addr load_PC, InstSeqNum load_seq_num,
+                   ThreadID tid) override {}
+
+    void insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                     ThreadID tid) override {}
+
+    void checkInst(Addr PC, ThreadID tid,
+                   std::vector<InstSeqNum> &producers) override {}
+
+    void issued(Addr issued_PC, InstSeqNum issued_seq_num,
+                bool is_store) override {}
+
+    void squash(InstSeqNum squashed_num, ThreadID tid) override {}
+
+    void clear() override {}
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_MEM_DEP_PRED_HH__
@@ -34,9 +34,12 @@
 
 #include "base/compiler.hh"
 #include "base/debug.hh"
+#include "cpu/o3/cpu.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/inst_queue.hh"
 #include "cpu/o3/limits.hh"
+#include "cpu/o3/store_distance.hh"
+#include "cpu/o3/store_set.hh"
 #include "debug/MemDepUnit.hh"
 #include "params/BaseO3CPU.hh"
 
@@ -52,13 +55,38 @@ int MemDepUnit::MemDepEntry::memdep_insert = 0;
 int MemDepUnit::MemDepEntry::memdep_erase = 0;
 #endif
 
-MemDepUnit::MemDepUnit() : iqPtr(NULL), stats(nullptr) {}
+namespace
+{
+
+/** Creates the memory dependence predictor selected by the parameters. */
+std::unique_ptr<MemDepPredictor>
+makeDepPred(const BaseO3CPUParams &params)
+{
+    switch (params.memDepPredictor) {
+      case MemDepPredictorType::StoreSet:
+        return std::make_unique<StoreSet>(params.store_set_clear_period,
+                                          params.SSITSize, params.LFSTSize);
+      case MemDepPredictorType::StoreDistance:
+        return std::make_unique<StoreDistance>(
+                params.store_set_clear_period,
+                params.storeDistanceTableSize, params.SQEntries);
+      case MemDepPredictorType::Conservative:
+        return std::make_unique<ConservativeMemDepPred>();
+      case MemDepPredictorType::Speculative:
+        return std::make_unique<SpeculativeMemDepPred>();
+      default:
+        panic("Unknown memory dependence predictor.");
+    }
+}
+
+} // anonymous namespace
+
+MemDepUnit::MemDepUnit() : iqPtr(NULL), cpu(nullptr), stats(nullptr) {}
 
 MemDepUnit::MemDepUnit(const BaseO3CPUParams &params)
     : _name(params.name + ".memdepunit"),
-      depPred(params.store_set_clear_period, params.SSITSize,
-              params.LFSTSize),
       iqPtr(NULL),
+      cpu(nullptr),
       stats(nullptr)
 {
     DPRINTF(MemDepUnit, "Creating MemDepUnit object.\n");
@@ -95,12 +123,17 @@ MemDepUnit::init(const BaseO3CPUParams &params, ThreadID tid, CPU *cpu)
 
     _name = csprintf("%s.memDep%d", params.name, tid);
     id = tid;
+    this->cpu = cpu;
 
-    depPred.init(params.store_set_clear_period, params.SSITSize,
-            params.LFSTSize);
+    depPred = makeDepPred(params);
 
     std::string stats_group_name = csprintf("MemDepUnit__%i", tid);
     cpu->addStatGroup(stats_group_name.c_str(), &stats);
+
+    if (tid < cpu->numThreads) {
+        stats.violationsPerKiloInst =
+            stats.violations * 1000 / cpu->commitStats[tid]->numInsts;
+    }
 }
 
 MemDepUnit::MemDepUnitStats::MemDepUnitStats(statistics::Group *parent)
@@ -112,8 +145,21 @@ MemDepUnit::MemDepUnitStats::MemDepUnitStats(statistics::Group *parent)
       ADD_STAT(conflictingLoads, statistics::units::Count::get(),
                "Number of conflicting loads."),
       ADD_STAT(conflictingStores, statistics::units::Count::get(),
-               "Number of conflicting stores.")
+               "Number of conflicting stores."),
+      ADD_STAT(violations, statistics::units::Count::get(),
+               "Number of memory order violations."),
+      ADD_STAT(violationsPerKiloInst, statistics::units::Rate<
+                    statistics::units::Count, statistics::units::Count>::get(),
+               "Memory order violations per thousand committed "
+               "instructions."),
+      ADD_STAT(falseDependences, statistics::units::Count::get(),
+               "Number of loads that waited on predicted stores they did "
+               "not overlap."),
+      ADD_STAT(falseDependenceStallCycles, statistics::units::Cycle::get(),
+               "Number of cycles loads with ready registers waited on "
+               "predicted stores they did not overlap.")
 {
+    violationsPerKiloInst.precision(6);
 }
 
 bool
@@ -145,7 +191,7 @@ MemDepUnit::takeOverFrom()
     // Be sure to reset all state.
     loadBarrierSNs.clear();
     storeBarrierSNs.clear();
-    depPred.clear();
+    depPred->clear();
 }
 
 void
@@ -220,9 +266,9 @@ MemDepUnit::insert(const DynInstPtr &inst)
                                 std::begin(storeBarrierSNs),
                                 std::end(storeBarrierSNs));
     } else {
-        InstSeqNum dep = depPred.checkInst(inst->pcState().instAddr());
-        if (dep != 0)
-            producing_stores.push_back(dep);
+        depPred->checkInst(inst->pcState().instAddr(), tid,
+                           producing_stores);
+        inst_entry->predictedDeps = true;
     }
 
     std::vector<MemDepEntryPtr> store_entries;
@@ -261,6 +307,7 @@ MemDepUnit::insert(const DynInstPtr &inst)
 
         if (inst->readyToIssue()) {
             inst_entry->regsReady = true;
+            inst_entry->regsReadyCycle = cpu->curCycle();
         }
 
         // Clear the bit saying this instruction can issue.
@@ -286,7 +333,7 @@ MemDepUnit::insert(const DynInstPtr &inst)
         DPRINTF(MemDepUnit, "Inserting store/atomic PC %s [sn:%lli].\n",
                 inst->pcState(), inst->seqNum);
 
-        depPred.insertStore(inst->pcState().instAddr(), inst->seqNum,
+        depPred->insertStore(inst->pcState().instAddr(), inst->seqNum,
                 inst->threadNumber);
 
         ++stats.insertedStores;
@@ -308,7 +355,7 @@ MemDepUnit::insertNonSpec(const DynInstPtr &inst)
         DPRINTF(MemDepUnit, "Inserting store/atomic PC %s [sn:%lli].\n",
                 inst->pcState(), inst->seqNum);
 
-        depPred.insertStore(inst->pcState().instAddr(), inst->seqNum,
+        depPred->insertStore(inst->pcState().instAddr(), inst->seqNum,
                 inst->threadNumber);
 
         ++stats.insertedStores;
@@ -351,6 +398,7 @@ MemDepUnit::regsReady(const DynInstPtr &inst)
     MemDepEntryPtr inst_entry = findInHash(inst);
 
     inst_entry->regsReady = true;
+    inst_entry->regsReadyCycle = cpu->curCycle();
 
     if (inst_entry->memDeps == 0) {
         DPRINTF(MemDepUnit, "Instruction has its memory "
@@ -363,6 +411,16 @@ MemDepUnit::regsReady(const DynInstPtr &inst)
     }
 }
 
+void
+MemDepUnit::regsNotReady(const DynInstPtr &inst)
+{
+    DPRINTF(MemDepUnit, "Marking registers as not ready for "
+            "instruction PC %s [sn:%lli].\n",
+            inst->pcState(), inst->seqNum);
+
+    findInHash(inst)->regsReady = false;
+}
+
 void
 MemDepUnit::nonSpecInstReady(const DynInstPtr &inst)
 {
@@ -427,6 +485,7 @@ MemDepUnit::completed(const DynInstPtr &inst)
 void
 MemDepUnit::completeInst(const DynInstPtr &inst)
 {
+    checkFalseDependence(inst);
     wakeDependents(inst);
     completed(inst);
     InstSeqNum barr_sn = inst->seqNum;
@@ -481,6 +540,16 @@ MemDepUnit::wakeDependents(const DynInstPtr &inst)
         assert(woken_inst->memDeps > 0);
         woken_inst->memDeps -= 1;
 
+        if (woken_inst->predictedDeps && inst->effAddrValid()) {
+            woken_inst->producerRanges.emplace_back(inst->effAddr,
+                                                    inst->effSize);
+        }
+
+        if (woken_inst->memDeps == 0 && woken_inst->regsReady) {
+            woken_inst->memDepStallCycles =
+                cpu->curCycle() - woken_inst->regsReadyCycle;
+        }
+
         if ((woken_inst->memDeps == 0) &&
             woken_inst->regsReady &&
             !woken_inst->squashed) {
@@ -491,6 +560,33 @@ MemDepUnit::wakeDependents(const DynInstPtr &inst)
     inst_entry->dependInsts.clear();
 }
 
+void
+MemDepUnit::checkFalseDependence(const DynInstPtr &inst)
+{
+    if (!inst->isLoad() || !inst->effAddrValid())
+        return;
+
+    MemDepEntryPtr inst_entry = findInHash(inst);
+
+    // Only loads that actually waited on a predicted store are counted.
+    if (!inst_entry->predictedDeps || inst_entry->producerRanges.empty())
+        return;
+
+    Addr load_start = inst->effAddr;
+    Addr load_end = inst->effAddr + inst->effSize;
+    for (const auto &range : inst_entry->producerRanges) {
+        if (range.first < load_end && load_start < range.first + range.second)
+            return;
+    }
+
+    DPRINTF(MemDepUnit, "False dependence for load PC %s [sn:%lli], "
+            "stalled %llu cycles.\n", inst->pcState(), inst->seqNum,
+            inst_entry->memDepStallCycles);
+
+    ++stats.falseDependences;
+    stats.falseDependenceStallCycles += inst_entry->memDepStallCycles;
+}
+
 MemDepUnit::MemDepEntry::MemDepEntry(const DynInstPtr &new_inst) :
     inst(new_inst)
 {
@@ -564,19 +660,23 @@ MemDepUnit::squash(const InstSeqNum &squashed_num, ThreadID tid)
     }
 
     // Tell the dependency predictor to squash as well.
-    depPred.squash(squashed_num, tid);
+    depPred->squash(squashed_num, tid);
 }
 
 void
 MemDepUnit::violation(const DynInstPtr &store_inst,
         const DynInstPtr &violating_load)
 {
-    DPRINTF(MemDepUnit, "Passing violating PCs to store sets,"
+    DPRINTF(MemDepUnit, "Passing violating PCs to the dependence predictor,"
             " load: %#x, store: %#x\n", violating_load->pcState().instAddr(),
             store_inst->pcState().instAddr());
+
+    ++stats.violations;
+
     // Tell the memory dependence unit of the violation.
-    depPred.violation(store_inst->pcState().instAddr(),
-            violating_load->pcState().instAddr());
+    depPred->violation(store_inst->pcState().instAddr(), store_inst->seqNum,
+            violating_load->pcState().instAddr(), violating_load->seqNum,
+            violating_load->threadNumber);
 }
 
 void
@@ -585,7 +685,8 @@ MemDepUnit::issue(const DynInstPtr &inst)
     DPRINTF(MemDepUnit, "Issuing instruction PC %#x [sn:%lli].\n",
             inst->pcState().instAddr(), inst->seqNum);
 
-    depPred.issued(inst->pcState().instAddr(), inst->seqNum, inst->isStore());
+    depPred->issued(inst->pcState().instAddr(), inst->seqNum,
+                    inst->isStore());
 }
 
 MemDepUnit::MemDepEntryPtr &
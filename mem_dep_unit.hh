@@ -46,12 +46,15 @@
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "base/statistics.hh"
+#include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/limits.hh"
-#include "cpu/o3/store_set.hh"
+#include "cpu/o3/mem_dep_pred.hh"
 #include "debug/MemDepUnit.hh"
 
 namespace gem5
@@ -132,6 +135,11 @@ class MemDepUnit
     /** Indicate that an instruction has its registers ready. */
     void regsReady(const DynInstPtr &inst);
 
+    /** Indicate that an instruction woken speculatively has to wait for
+     * its registers again.
+     */
+    void regsNotReady(const DynInstPtr &inst);
+
     /** Indicate that a non-speculative instruction is ready. */
     void nonSpecInstReady(const DynInstPtr &inst);
 
@@ -169,6 +177,11 @@ class MemDepUnit
     /** Wakes any dependents of a memory instruction. */
     void wakeDependents(const DynInstPtr &inst);
 
+    /** Counts a completed load whose predicted store dependences turned
+     * out not to overlap it as a false dependence.
+     */
+    void checkFalseDependence(const DynInstPtr &inst);
+
     typedef typename std::list<DynInstPtr>::iterator ListIt;
 
     class MemDepEntry;
@@ -208,6 +221,16 @@ class MemDepUnit
         bool completed = false;
         /** If the instruction is squashed. */
         bool squashed = false;
+        /** If the memory dependences came from the predictor. */
+        bool predictedDeps = false;
+        /** Cycle at which the registers became ready. */
+        Cycles regsReadyCycle = Cycles(0);
+        /** Cycles spent waiting only on memory dependences. */
+        Cycles memDepStallCycles = Cycles(0);
+        /** Address ranges written by the producer stores, as start and
+         * size, used to tell true from false dependences.
+         */
+        std::vector<std::pair<Addr, unsigned>> producerRanges;
 
         /** For debugging. */
 #ifdef GEM5_DEBUG
@@ -239,9 +262,9 @@ class MemDepUnit
     /** The memory dependence predictor.  It is accessed upon new
      *  instructions being added to the IQ, and responds by telling
      *  this unit what instruction the newly added instruction is dependent
-     *  upon.
+     *  upon. Built by init() from the selected predictor type.
      */
-    StoreSet depPred;
+    std::unique_ptr<MemDepPredictor> depPred;
 
     /** Sequence numbers of outstanding load barriers. */
     std::unordered_set<InstSeqNum> loadBarrierSNs;
@@ -261,6 +284,9 @@ class MemDepUnit
     /** Pointer to the IQ. */
     InstructionQueue *iqPtr;
 
+    /** Pointer to the CPU. */
+    CPU *cpu;
+
     /** The thread id of this memory dependence unit. */
     int id;
     struct MemDepUnitStats : public statistics::Group
@@ -276,6 +302,17 @@ class MemDepUnit
         /** Stat for number of conflicting stores that had to wait for a
          *  store. */
         statistics::Scalar conflictingStores;
+        /** Stat for number of memory order violations. */
+        statistics::Scalar violations;
+        /** Stat for memory order violations per thousand committed
+         *  instructions. */
+        statistics::Formula violationsPerKiloInst;
+        /** Stat for number of loads made to wait on predicted stores that
+         *  they did not overlap. */
+        statistics::Scalar falseDependences;
+        /** Stat for cycles loads with ready registers spent waiting on
+         *  predicted stores that they did not overlap. */
+        statistics::Scalar falseDependenceStallCycles;
     } stats;
 };
 
@@ -0,0 +1,77 @@
+#include "cpu/o3/mem_rename.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/MemRename.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+MemRenamePredictor::init(const std::string &name, unsigned table_size)
+{
+    _name = name;
+
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid memory renaming table size!\n");
+    }
+
+    table.resize(table_size);
+    indexMask = table_size - 1;
+}
+
+bool
+MemRenamePredictor::lookup(Addr load_pc, Addr &store_pc,
+                           int &data_idx) const
+{
+    const Entry &entry = table[calcIndex(load_pc)];
+
+    if (!entry.valid || entry.loadPC != load_pc ||
+        entry.confidence < confThreshold) {
+        return false;
+    }
+
+    store_pc = entry.storePC;
+    data_idx = entry.dataIdx;
+    return true;
+}
+
+void
+MemRenamePredictor::train(Addr load_pc, Addr store_pc, int data_idx)
+{
+    Entry &entry = table[calcIndex(load_pc)];
+
+    if (entry.valid && entry.loadPC == load_pc &&
+        entry.storePC == store_pc && entry.dataIdx == data_idx) {
+        if (entry.confidence < maxConfidence)
+            entry.confidence++;
+    } else {
+        entry.valid = true;
+        entry.loadPC = load_pc;
+        entry.storePC = store_pc;
+        entry.dataIdx = data_idx;
+        entry.confidence = 1;
+    }
+
+    DPRINTF(MemRename, "Load PC %#x forwarded from store PC %#x, "
+            "confidence %u.\n", load_pc, store_pc, entry.confidence);
+}
+
+void
+MemRenamePredictor::mispredict(Addr load_pc)
+{
+    Entry &entry = table[calcIndex(load_pc)];
+
+    if (entry.valid && entry.loadPC == load_pc) {
+        DPRINTF(MemRename, "Load PC %#x mispredicted, clearing "
+                "confidence.\n", load_pc);
+        entry.confidence = 0;
+    }
+}
+
+} // namespace o3
+} // namespace gem5
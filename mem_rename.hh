@@ -0,0 +1,90 @@
+#ifndef __CPU_O3_MEM_RENAME_HH__
+#define __CPU_O3_MEM_RENAME_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Memory renaming predictor. Remembers, per load PC, the store PC that
+ * last forwarded all of the load's data in the store queue, and which of
+ * the store's sources held that data, along with a saturating confidence
+ * counter. Only forwards of a whole register, whose value the load reads
+ * back unchanged, are learnt. Rename uses a confident prediction to hand
+ * the load the store's data register directly, so the load's dependents
+ * do not wait for the store-queue search.
+ */
+class MemRenamePredictor
+{
+  public:
+    /** Default constructor.  init() must be called prior to use. */
+    MemRenamePredictor() { };
+
+    /** Initializes the predictor with the given table size. */
+    void init(const std::string &name, unsigned table_size);
+
+    /** Whether the predictor was initialized, i.e. memory renaming is
+     * enabled.
+     */
+    bool enabled() const { return !table.empty(); }
+
+    /**
+     * Looks up the store a load is expected to read from.
+     * @param load_pc PC of the load.
+     * @param store_pc Set to the PC of the predicted store.
+     * @param data_idx Set to the store's source index holding the data.
+     * @return Whether the prediction is confident enough to use.
+     */
+    bool lookup(Addr load_pc, Addr &store_pc, int &data_idx) const;
+
+    /** Records that a store fully forwarded the register in its source
+     * data_idx to a load.
+     */
+    void train(Addr load_pc, Addr store_pc, int data_idx);
+
+    /** Records that a renamed load did not get the store's value. */
+    void mispredict(Addr load_pc);
+
+    /** Name of the predictor, for DPRINTF. */
+    const std::string &name() const { return _name; }
+
+  private:
+    struct Entry
+    {
+        bool valid = false;
+        Addr loadPC = 0;
+        Addr storePC = 0;
+        int dataIdx = 0;
+        unsigned confidence = 0;
+    };
+
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr load_pc) const
+    {
+        return (load_pc >> 1) & indexMask;
+    }
+
+    std::string _name;
+
+    std::vector<Entry> table;
+
+    unsigned indexMask;
+
+    /** Saturation value of the confidence counters. */
+    static constexpr unsigned maxConfidence = 7;
+
+    /** Confidence needed before a load is renamed. */
+    static constexpr unsigned confThreshold = 4;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_MEM_RENAME_HH__
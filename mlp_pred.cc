@@ -0,0 +1,51 @@
+#include "cpu/o3/mlp_pred.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+MLPPredictor::init(unsigned table_size, unsigned window,
+                   Cycles long_latency)
+{
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid MLP predictor table size!\n");
+    }
+
+    // Loads that were never seen miss are assumed to have MLP, so a
+    // thread is not throttled before the predictor has learnt anything.
+    table.assign(table_size, window);
+    indexMask = table_size - 1;
+    windowSize = window;
+    _longLatency = long_latency;
+}
+
+void
+MLPPredictor::commitInst(ThreadID tid, Addr pc, bool long_latency)
+{
+    uint64_t pos = ++committed[tid];
+    auto &loads = pending[tid];
+
+    // Loads whose window has closed keep the distance of the youngest
+    // long-latency load that fell within it.
+    while (!loads.empty() && pos - loads.front().pos > windowSize) {
+        table[calcIndex(loads.front().pc)] = loads.front().distance;
+        loads.pop_front();
+    }
+
+    if (!long_latency)
+        return;
+
+    for (auto &load : loads)
+        load.distance = pos - load.pos;
+
+    loads.push_back({pc, pos, 0});
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,79 @@
+#ifndef __CPU_O3_MLP_PRED_HH__
+#define __CPU_O3_MLP_PRED_HH__
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/o3/limits.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * PC-indexed memory-level parallelism predictor, for the MLP-aware SMT
+ * fetch policy. See "A Memory-Level Parallelism Aware Fetch Policy for
+ * SMT Processors" by Eyerman and Eeckhout.
+ *
+ * Each long-latency load remembers its MLP distance: how many
+ * instructions past it the youngest other long-latency load within one
+ * ROB window was, in committed program order. A distance of 0 marks an
+ * isolated miss with no MLP to exploit.
+ */
+class MLPPredictor
+{
+  public:
+    /** Default constructor.  init() must be called prior to use. */
+    MLPPredictor() { };
+
+    /** Initializes the predictor.
+     * @param table_size Number of load entries, a power of 2.
+     * @param window Instruction window the distance is measured over.
+     * @param long_latency Latency from which a load counts as a miss.
+     */
+    void init(unsigned table_size, unsigned window, Cycles long_latency);
+
+    /** Latency from which a load counts as long-latency. */
+    Cycles longLatency() const { return _longLatency; }
+
+    /** Returns the predicted MLP distance of the load at the given PC. */
+    unsigned predict(Addr pc) const { return table[calcIndex(pc)]; }
+
+    /** Trains on a committed instruction, in program order. */
+    void commitInst(ThreadID tid, Addr pc, bool long_latency);
+
+  private:
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr pc) const { return (pc >> 1) & indexMask; }
+
+    /** A committed long-latency load whose window is still open. */
+    struct PendingLoad
+    {
+        Addr pc;
+        uint64_t pos;
+        unsigned distance;
+    };
+
+    std::vector<uint16_t> table;
+
+    unsigned indexMask;
+
+    unsigned windowSize;
+
+    Cycles _longLatency;
+
+    /** Open long-latency loads of each thread, oldest first. */
+    std::deque<PendingLoad> pending[MaxThreads];
+
+    /** Committed instruction count of each thread. */
+    uint64_t committed[MaxThreads] = {};
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_MLP_PRED_HH__
@@ -41,6 +41,10 @@
 
 #include "cpu/o3/regfile.hh"
 
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/free_list.hh"
 
 namespace gem5
@@ -193,5 +197,83 @@ PhysRegFile::initFreeList(UnifiedFreeList *freeList)
     freeList->addRegs(ccRegIds.begin(), ccRegIds.end());
 }
 
+void
+PhysRegFile::initBanks(unsigned banks, unsigned read_ports,
+                       unsigned write_ports)
+{
+    fatal_if(!read_ports || !write_ports,
+             "A banked register file needs read and write ports.\n");
+
+    numBanks = banks;
+    readPortsPerBank = read_ports;
+    writePortsPerBank = write_ports;
+    readPortsUsed.assign(banks, 0);
+    writePortsUsed.assign(banks, 0);
+}
+
+void
+PhysRegFile::updatePortCycle(Cycles now)
+{
+    if (now == portCycle)
+        return;
+
+    portCycle = now;
+    std::fill(readPortsUsed.begin(), readPortsUsed.end(), 0);
+    std::fill(writePortsUsed.begin(), writePortsUsed.end(), 0);
+}
+
+bool
+PhysRegFile::usePorts(std::vector<unsigned> &used, unsigned ports,
+                      const std::vector<PhysRegIdPtr> &regs, bool claim)
+{
+    std::vector<unsigned> needed(numBanks, 0);
+
+    for (auto reg : regs) {
+        if (reg->is(InvalidRegClass) || reg->is(MiscRegClass))
+            continue;
+
+        ++needed[reg->flatIndex() % numBanks];
+    }
+
+    // An idle bank always grants its accesses, so registers that share a
+    // bank beyond its ports take it for the whole cycle rather than
+    // never being served.
+    for (unsigned bank = 0; bank < numBanks; bank++) {
+        if (used[bank] && used[bank] + needed[bank] > ports)
+            return false;
+    }
+
+    if (claim) {
+        for (unsigned bank = 0; bank < numBanks; bank++)
+            used[bank] += needed[bank];
+    }
+
+    return true;
+}
+
+bool
+PhysRegFile::readPorts(const DynInstPtr &inst, Cycles now, bool claim)
+{
+    updatePortCycle(now);
+
+    std::vector<PhysRegIdPtr> regs;
+    for (int i = 0; i < inst->numSrcRegs(); i++)
+        regs.push_back(inst->renamedSrcIdx(i));
+
+    return usePorts(readPortsUsed, readPortsPerBank, regs, claim);
+}
+
+bool
+PhysRegFile::writePorts(const DynInstPtr &inst, Cycles now, bool claim)
+{
+    updatePortCycle(now);
+
+    std::vector<PhysRegIdPtr> regs;
+    for (int i = 0; i < inst->numDestRegs(); i++)
+        regs.push_back(inst->renamedDestIdx(i));
+
+    return usePorts(writePortsUsed, writePortsPerBank, regs, claim);
+}
+
 } // namespace o3
 } // namespace gem5
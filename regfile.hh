@@ -140,6 +140,35 @@ class PhysRegFile
     /** Total number of physical registers. */
     unsigned totalNumRegs;
 
+    /** Number of register file banks, or 0 for unlimited ports. */
+    unsigned numBanks = 0;
+
+    /** Read ports of each bank. */
+    unsigned readPortsPerBank = 0;
+
+    /** Write ports of each bank. */
+    unsigned writePortsPerBank = 0;
+
+    /** Cycle the port usage below was counted for. */
+    Cycles portCycle = Cycles(0);
+
+    /** Read ports of each bank in use this cycle. */
+    std::vector<unsigned> readPortsUsed;
+
+    /** Write ports of each bank in use this cycle. */
+    std::vector<unsigned> writePortsUsed;
+
+    /** Forgets the port usage of earlier cycles. */
+    void updatePortCycle(Cycles now);
+
+    /**
+     * Checks, and if claim is set takes, a port on the bank of each of the
+     * given registers. Registers outside the file take no port, and an
+     * idle bank grants every access, however many ports it needs.
+     */
+    bool usePorts(std::vector<unsigned> &used, unsigned ports,
+                  const std::vector<PhysRegIdPtr> &regs, bool claim);
+
   public:
     /**
      * Constructs a physical register file with the specified amount of
@@ -164,6 +193,29 @@ class PhysRegFile
     /** @return the total number of physical registers. */
     unsigned totalNumPhysRegs() const { return totalNumRegs; }
 
+    /**
+     * Splits the register file into banks with a limited number of read
+     * and write ports each. Registers are interleaved across the banks by
+     * flat index. Without it every access gets a port.
+     */
+    void initBanks(unsigned banks, unsigned read_ports,
+                   unsigned write_ports);
+
+    /** Whether register file ports are modelled. */
+    bool banked() const { return numBanks != 0; }
+
+    /**
+     * Checks whether an instruction could read its source operands this
+     * cycle, and takes the read ports if claim is set.
+     */
+    bool readPorts(const DynInstPtr &inst, Cycles now, bool claim);
+
+    /**
+     * Checks whether an instruction could write its destinations this
+     * cycle, and takes the write ports if claim is set.
+     */
+    bool writePorts(const DynInstPtr &inst, Cycles now, bool claim);
+
     /** Gets a misc register PhysRegIdPtr. */
     PhysRegIdPtr getMiscRegId(RegIndex reg_idx) {
         return &miscRegIds[reg_idx];
@@ -41,8 +41,13 @@
 
 #include "cpu/o3/rename.hh"
 
+#include <algorithm>
 #include <list>
+#include <unordered_set>
 
+#include "base/intmath.hh"
+#include "base/loader/object_file.hh"
+#include "base/logging.hh"
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/limits.hh"
@@ -51,6 +56,8 @@
 #include "debug/O3PipeView.hh"
 #include "debug/Rename.hh"
 #include "params/BaseO3CPU.hh"
+#include "sim/system.hh"
+#include "sim/workload.hh"
 
 namespace gem5
 {
@@ -60,6 +67,11 @@ namespace o3
 
 Rename::Rename(CPU *_cpu, const BaseO3CPUParams &params)
     : cpu(_cpu),
+      zeroReg(nullptr),
+      moveElimination(params.moveElimination),
+      memRenaming(params.memRenaming),
+      earlyRegRelease(params.earlyRegRelease),
+      numCheckpoints(params.numRenameCheckpoints),
       iewToRenameDelay(params.iewToRenameDelay),
       decodeToRenameDelay(params.decodeToRenameDelay),
       commitToRenameDelay(params.commitToRenameDelay),
@@ -72,8 +84,26 @@ Rename::Rename(CPU *_cpu, const BaseO3CPUParams &params)
              "\tincrease MaxWidth in src/cpu/o3/limits.hh\n",
              renameWidth, static_cast<int>(MaxWidth));
 
+    branchConf.init(params.branchConfidenceTableSize);
+
+    // Idioms are recognised from their encoding, which is only decoded
+    // for RISC-V; other ISAs keep executing their moves.
+    if (moveElimination) {
+        loader::Arch arch = params.system->workload->getArch();
+        if (arch != loader::Riscv64 && arch != loader::Riscv32) {
+            warn("moveElimination only knows RISC-V idioms, disabling "
+                 "it.\n");
+            moveElimination = false;
+        }
+    }
+
     // @todo: Make into a parameter.
-    skidBufferMax = (decodeToRenameDelay + 1) * params.decodeWidth;
+    // Fused tails ride along with their head, so with fusion enabled
+    // decode can hand over up to twice its width each cycle.
+    skidBufferMax = (decodeToRenameDelay + 1) *
+        (params.macroOpFusion ?
+         std::min<unsigned>(2 * params.decodeWidth, MaxWidth) :
+         params.decodeWidth);
     for (uint32_t tid = 0; tid < MaxThreads; tid++) {
         renameStatus[tid] = Idle;
         renameMap[tid] = nullptr;
@@ -85,6 +115,7 @@ Rename::Rename(CPU *_cpu, const BaseO3CPUParams &params)
         stalls[tid] = {false, false};
         serializeInst[tid] = nullptr;
         serializeOnNextInst[tid] = false;
+        walkDoneCycle[tid] = Cycles(0);
     }
 }
 
@@ -145,7 +176,35 @@ Rename::RenameStats::RenameStats(statistics::Group *parent)
       ADD_STAT(tempSerializing, statistics::units::Count::get(),
                "count of temporary serializing insts renamed"),
       ADD_STAT(skidInsts, statistics::units::Count::get(),
-               "count of insts added to the skid buffer")
+               "count of insts added to the skid buffer"),
+      ADD_STAT(movesEliminated, statistics::units::Count::get(),
+               "Number of register moves eliminated at rename"),
+      ADD_STAT(zeroIdiomsEliminated, statistics::units::Count::get(),
+               "Number of zero idioms eliminated at rename"),
+      ADD_STAT(memRenamedLoads, statistics::units::Count::get(),
+               "Number of loads renamed onto the data register of a store"),
+      ADD_STAT(checkpointsTaken, statistics::units::Count::get(),
+               "Number of rename map checkpoints taken at low confidence "
+               "branches"),
+      ADD_STAT(checkpointsUnavailable, statistics::units::Count::get(),
+               "Number of low confidence branches renamed while all "
+               "checkpoints were in use"),
+      ADD_STAT(checkpointRestores, statistics::units::Count::get(),
+               "Number of squashes that restored the rename map from a "
+               "checkpoint"),
+      ADD_STAT(checkpointMapsSkipped, statistics::units::Count::get(),
+               "Number of HB maps not walked because a checkpoint was "
+               "restored"),
+      ADD_STAT(checkpointWalkCyclesSaved, statistics::units::Cycle::get(),
+               "Cycles of history buffer walk saved by checkpoint restores"),
+      ADD_STAT(squashWalkCycles, statistics::units::Cycle::get(),
+               "Cycles of history buffer walk charged to squashes without "
+               "a checkpoint"),
+      ADD_STAT(earlyReleases, statistics::units::Count::get(),
+               "Number of physical registers released before their "
+               "redefiner committed"),
+      ADD_STAT(earlyReleaseRestores, statistics::units::Count::get(),
+               "Number of early released values restored by a squash")
 {
     squashCycles.prereq(squashCycles);
     idleCycles.prereq(idleCycles);
@@ -176,6 +235,17 @@ Rename::RenameStats::RenameStats(statistics::Group *parent)
     serializing.flags(statistics::total);
     tempSerializing.flags(statistics::total);
     skidInsts.flags(statistics::total);
+    movesEliminated.prereq(movesEliminated);
+    zeroIdiomsEliminated.prereq(zeroIdiomsEliminated);
+    memRenamedLoads.prereq(memRenamedLoads);
+    checkpointsTaken.prereq(checkpointsTaken);
+    checkpointsUnavailable.prereq(checkpointsUnavailable);
+    checkpointRestores.prereq(checkpointRestores);
+    checkpointMapsSkipped.prereq(checkpointMapsSkipped);
+    checkpointWalkCyclesSaved.prereq(checkpointWalkCyclesSaved);
+    squashWalkCycles.prereq(squashWalkCycles);
+    earlyReleases.prereq(earlyReleases);
+    earlyReleaseRestores.prereq(earlyReleaseRestores);
 }
 
 void
@@ -243,6 +313,10 @@ Rename::clearStates(ThreadID tid)
     instsInProgress[tid] = 0;
     loadsInProgress[tid] = 0;
     storesInProgress[tid] = 0;
+    renamedStores[tid].clear();
+    checkpoints[tid].clear();
+    renamedBranches[tid].clear();
+    walkDoneCycle[tid] = Cycles(0);
 
     serializeOnNextInst[tid] = false;
 }
@@ -273,6 +347,9 @@ Rename::resetStage()
         instsInProgress[tid] = 0;
         loadsInProgress[tid] = 0;
         storesInProgress[tid] = 0;
+        checkpoints[tid].clear();
+        renamedBranches[tid].clear();
+        walkDoneCycle[tid] = Cycles(0);
 
         serializeOnNextInst[tid] = false;
     }
@@ -388,6 +465,16 @@ Rename::squash(const InstSeqNum &squash_seq_num, ThreadID tid)
     doSquash(squash_seq_num, tid);
 }
 
+bool
+Rename::hasCheckpoint(InstSeqNum seq_num, ThreadID tid) const
+{
+    for (const auto &checkpoint : checkpoints[tid]) {
+        if (checkpoint.seqNum == seq_num)
+            return true;
+    }
+    return false;
+}
+
 void
 Rename::tick()
 {
@@ -398,6 +485,7 @@ Rename::tick()
     bool status_change = false;
 
     toIEWIndex = 0;
+    fusedThisCycle = 0;
 
     sortInsts();
 
@@ -437,6 +525,10 @@ Rename::tick()
             removeFromHistory(fromCommit->commitInfo[tid].doneSeqNum,
                                   tid);
         }
+
+        if (earlyRegRelease && renameStatus[tid] != Squashing) {
+            releaseEarly(tid);
+        }
     }
 
     // @todo: make into updateProgress function
@@ -528,6 +620,10 @@ Rename::renameInsts(ThreadID tid)
         ++stats.runCycles;
     }
 
+    // Instructions renamed in Precise Runahead never enter the ROB or the
+    // LSQ, so only the IQ limits how many can be renamed.
+    bool runahead = cpu->preciseRunahead.isActive(tid);
+
     // Will have to do a different calculation for the number of free
     // entries.
     int free_rob_entries = calcFreeROBEntries(tid);
@@ -536,7 +632,7 @@ Rename::renameInsts(ThreadID tid)
 
     FullSource source = ROB;
 
-    if (free_iq_entries < min_free_entries) {
+    if (free_iq_entries < min_free_entries || runahead) {
         min_free_entries = free_iq_entries;
         source = IQ;
     }
@@ -597,7 +693,9 @@ Rename::renameInsts(ThreadID tid)
 
     int renamed_insts = 0;
 
-    while (insts_available > 0 &&  toIEWIndex < renameWidth) {
+    while (insts_available > 0 && toIEWIndex < MaxWidth &&
+           (toIEWIndex - fusedThisCycle < renameWidth ||
+            insts_to_rename.front()->isFusedTail())) {
         DPRINTF(Rename, "[tid:%i] Sending instructions to IEW.\n", tid);
 
         assert(!insts_to_rename.empty());
@@ -609,7 +707,7 @@ Rename::renameInsts(ThreadID tid)
         //For store instruction, check SQ size and take into account the
         //inflight stores
 
-        if (inst->isLoad()) {
+        if (inst->isLoad() && !runahead) {
             if (calcFreeLQEntries(tid) <= 0) {
                 DPRINTF(Rename, "[tid:%i] Cannot rename due to no free LQ\n",
                         tid);
@@ -619,7 +717,7 @@ Rename::renameInsts(ThreadID tid)
             }
         }
 
-        if (inst->isStore() || inst->isAtomic()) {
+        if ((inst->isStore() || inst->isAtomic()) && !runahead) {
             if (calcFreeSQEntries(tid) <= 0) {
                 DPRINTF(Rename, "[tid:%i] Cannot rename due to no free SQ\n",
                         tid);
@@ -652,6 +750,21 @@ Rename::renameInsts(ThreadID tid)
             continue;
         }
 
+        // In runahead, instructions off the load slices are dropped here
+        // and never reach IEW.
+        if (runahead && !cpu->preciseRunahead.renameInst(inst)) {
+            DPRINTF(Rename,
+                    "[tid:%i] "
+                    "Dropping runahead instruction [sn:%llu] PC %s.\n",
+                    tid, inst->seqNum, inst->pcState());
+
+            inst->setSquashed();
+
+            --insts_available;
+
+            continue;
+        }
+
         DPRINTF(Rename,
                 "[tid:%i] "
                 "Processing instruction [sn:%llu] with PC %s.\n",
@@ -712,29 +825,47 @@ Rename::renameInsts(ThreadID tid)
 
         renameSrcRegs(inst, inst->threadNumber);
         renameDestRegs(inst, inst->threadNumber);
+
+        if (memRenaming && inst->isStore() && !inst->isAtomic() &&
+            !inst->isStoreConditional()) {
+            recordRenamedStore(inst, inst->threadNumber);
+        }
+
+        if (numCheckpoints && (inst->isCondCtrl() ||
+                (inst->isIndirectCtrl() && !inst->isReturn()))) {
+            renamedBranches[inst->threadNumber].push_back(
+                    {inst->seqNum, inst->pcState().instAddr()});
+            takeCheckpoint(inst, inst->threadNumber);
+        }
         
         // add logic to check stride PC
         Addr inst_pc = inst->pcState().instAddr();
-        if (cpu->isStridePC(inst_pc)) {
-            DPRINTF(Rename, "Instruction at PC 0x%lx is a stride load\n",
-                    inst->pcState().instAddr());
-            
-            // mark destination registers as tainted
-            for (int i = 0; i < inst->numDestRegs(); i++) {
-                PhysRegIdPtr dest_reg = inst->renamedDestIdx(i);
-                // print the value of this dest_reg
-                DPRINTF(Rename, "Dest register: %d\n", dest_reg->index());
-                // call CPU's taintRegister method
-                cpu->taintRegister(dest_reg, inst_pc);
+        if (cpu->preciseRunahead.enabled()) {
+            // Precise Runahead learns load slices instead of DVR chains.
+            cpu->taintScoreboard.recordSliceProducers(inst);
+        } else if (cpu->dvrRunahead()) {
+            if (cpu->isStridePC(inst_pc)) {
+                DPRINTF(Rename, "Instruction at PC 0x%lx is a stride load\n",
+                        inst->pcState().instAddr());
+
+                // mark destination registers as tainted
+                for (int i = 0; i < inst->numDestRegs(); i++) {
+                    PhysRegIdPtr dest_reg = inst->renamedDestIdx(i);
+                    // print the value of this dest_reg
+                    DPRINTF(Rename, "Dest register: %d\n",
+                            dest_reg->index());
+                    // call CPU's taintRegister method
+                    cpu->taintRegister(dest_reg, inst_pc);
+                }
+            } else {
+                // for non-stride load instructions, call propagateTaint
+                cpu->taintScoreboard.propagateTaint(inst);
             }
-        } else {
-            // for non-stride load instructions, call propagateTaint function
-            cpu->taintScoreboard.propagateTaint(inst);
         }
 
         if (inst->isAtomic() || inst->isStore()) {
             storesInProgress[tid]++;
-        } else if (inst->isLoad()) {
+        } else if (inst->isLoad() && !inst->isRunahead()) {
             loadsInProgress[tid]++;
         }
 
@@ -749,6 +880,8 @@ Rename::renameInsts(ThreadID tid)
 
         // Increment which instruction we're on.
         ++toIEWIndex;
+        if (inst->isFusedTail())
+            ++fusedThisCycle;
 
         // Decrement how many instructions are available.
         --insts_available;
@@ -932,6 +1065,29 @@ Rename::unblock(ThreadID tid)
 void
 Rename::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
 {
+    // Checkpoints of squashed branches can no longer be used.
+    while (!checkpoints[tid].empty() &&
+           checkpoints[tid].back().seqNum > squashed_seq_num) {
+        checkpoints[tid].pop_back();
+    }
+
+    // If the squash goes back to a checkpointed branch, the whole map is
+    // restored at once and the history entries below only have their
+    // registers freed.
+    bool restored = false;
+    if (!checkpoints[tid].empty() &&
+        checkpoints[tid].back().seqNum == squashed_seq_num) {
+        DPRINTF(Rename, "[tid:%i] Restoring rename map from the checkpoint "
+                "of PC %#x [sn:%llu].\n", tid, checkpoints[tid].back().pc,
+                squashed_seq_num);
+
+        *renameMap[tid] = checkpoints[tid].back().map;
+        checkpoints[tid].pop_back();
+        restored = true;
+        ++stats.checkpointRestores;
+    }
+
+    unsigned undone_maps = 0;
     auto hb_it = historyBuffer[tid].begin();
 
     // After a syscall squashes everything, the history buffer may be empty
@@ -953,10 +1109,16 @@ Rename::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
         // is the same as the old one.  While it would be merely a
         // waste of time to update the rename table, we definitely
         // don't want to put these on the free list.
-        if (hb_it->newPhysReg != hb_it->prevPhysReg) {
+        if (hb_it->released) {
+            // Written again even if a trap already restored it, as the
+            // redefiner may have executed since.
+            restoreReleased(*hb_it, tid);
+            ++stats.earlyReleaseRestores;
+        } else if (hb_it->newPhysReg != hb_it->prevPhysReg) {
             // Tell the rename map to set the architected register to the
             // previous physical register that it was renamed to.
-            renameMap[tid]->setEntry(hb_it->archReg, hb_it->prevPhysReg);
+            if (!restored)
+                renameMap[tid]->setEntry(hb_it->archReg, hb_it->prevPhysReg);
 
             // The phys regs can still be owned by squashing but
             // executing instructions in IEW at this moment. To avoid
@@ -974,6 +1136,31 @@ Rename::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
         historyBuffer[tid].erase(hb_it++);
 
         ++stats.undoneMaps;
+        ++undone_maps;
+    }
+
+    // Without a checkpoint the map is rebuilt by walking the history
+    // buffer, renameWidth entries a cycle, and rename stalls meanwhile.
+    if (undone_maps) {
+        Cycles walk_cycles(divCeil(undone_maps, renameWidth));
+        if (restored) {
+            stats.checkpointMapsSkipped += undone_maps;
+            stats.checkpointWalkCyclesSaved += walk_cycles;
+        } else {
+            walkDoneCycle[tid] = std::max(walkDoneCycle[tid],
+                                          cpu->curCycle() + walk_cycles);
+            stats.squashWalkCycles += walk_cycles;
+        }
+    }
+
+    while (!renamedBranches[tid].empty() &&
+           renamedBranches[tid].back().seqNum > squashed_seq_num) {
+        renamedBranches[tid].pop_back();
+    }
+
+    while (!renamedStores[tid].empty() &&
+           renamedStores[tid].back().seqNum > squashed_seq_num) {
+        renamedStores[tid].pop_back();
     }
 }
 
@@ -984,6 +1171,24 @@ Rename::removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid)
             "history buffer %u (size=%i), until [sn:%llu].\n",
             tid, tid, historyBuffer[tid].size(), inst_seq_num);
 
+    while (!renamedStores[tid].empty() &&
+           renamedStores[tid].front().seqNum <= inst_seq_num) {
+        renamedStores[tid].pop_front();
+    }
+
+    // Branches that commit without having mispredicted were predicted
+    // correctly, whether or not they got a checkpoint.
+    while (!renamedBranches[tid].empty() &&
+           renamedBranches[tid].front().seqNum <= inst_seq_num) {
+        branchConf.trainCorrect(renamedBranches[tid].front().pc);
+        renamedBranches[tid].pop_front();
+    }
+
+    while (!checkpoints[tid].empty() &&
+           checkpoints[tid].front().seqNum <= inst_seq_num) {
+        checkpoints[tid].pop_front();
+    }
+
     auto hb_it = historyBuffer[tid].end();
 
     --hb_it;
@@ -1015,8 +1220,8 @@ Rename::removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid)
 
         // Don't free special phys regs like misc and zero regs, which
         // can be recognized because the new mapping is the same as
-        // the old one.
-        if (hb_it->newPhysReg != hb_it->prevPhysReg) {
+        // the old one, nor ones that were already released early.
+        if (hb_it->newPhysReg != hb_it->prevPhysReg && !hb_it->released) {
             freeList->addReg(hb_it->prevPhysReg);
         }
 
@@ -1107,6 +1312,14 @@ Rename::renameDestRegs(const DynInstPtr &inst, ThreadID tid)
     unsigned num_dest_regs = inst->numDestRegs();
     auto *isa = tc->getIsaPtr();
 
+    if (moveElimination && eliminateIdiom(inst, tid))
+        return;
+
+    // A runahead load has no SQ to forward from and is squashed anyway.
+    if (memRenaming && !inst->isRunahead() &&
+        renameLoadFromStore(inst, tid))
+        return;
+
     // Rename the destination registers.
     for (int dest_idx = 0; dest_idx < num_dest_regs; dest_idx++) {
         const RegId& dest_reg = inst->destRegIdx(dest_idx);
@@ -1129,9 +1342,17 @@ Rename::renameDestRegs(const DynInstPtr &inst, ThreadID tid)
                 rename_result.first->flatIndex());
 
         // Record the rename information so that a history can be kept.
+        // Only scalar values can be saved for an early release, and
+        // runahead instructions are always squashed anyway.
+        RegClassType type = flat_dest_regid.classValue();
+        bool can_release = earlyRegRelease && !inst->isRunahead() &&
+            (type == IntRegClass || type == FloatRegClass ||
+             type == CCRegClass) &&
+            rename_result.first != rename_result.second;
         RenameHistory hb_entry(inst->seqNum, flat_dest_regid,
                                rename_result.first,
-                               rename_result.second);
+                               rename_result.second,
+                               can_release);
 
         historyBuffer[tid].push_front(hb_entry);
 
@@ -1153,11 +1374,360 @@ Rename::renameDestRegs(const DynInstPtr &inst, ThreadID tid)
     }
 }
 
+namespace
+{
+
+/**
+ * Recognises the RISC-V register move and zeroing forms, the only ones
+ * move elimination knows. Leaves is_zero and move_src alone for anything
+ * else.
+ */
+void
+decodeRiscvIdiom(uint32_t machine_inst, bool &is_zero, int &move_src)
+{
+    if ((machine_inst & 0x3) == 0x3) {
+        uint32_t opcode = machine_inst & 0x7f;
+        uint32_t funct3 = (machine_inst >> 12) & 0x7;
+        uint32_t funct7 = (machine_inst >> 25) & 0x7f;
+        int rs1 = (machine_inst >> 15) & 0x1f;
+        int rs2 = (machine_inst >> 20) & 0x1f;
+        int32_t imm = ((int32_t)machine_inst) >> 20;
+
+        if (opcode == 0x13 && imm == 0) {
+            // addi/xori/ori rd, rs1, 0 copy rs1; andi rd, rs1, 0 zeroes.
+            if (funct3 == 0x0 || funct3 == 0x4 || funct3 == 0x6) {
+                if (rs1 == 0)
+                    is_zero = true;
+                else
+                    move_src = rs1;
+            } else if (funct3 == 0x7) {
+                is_zero = true;
+            }
+        } else if (opcode == 0x33 && funct7 == 0x00) {
+            if (funct3 == 0x0 || funct3 == 0x6 || funct3 == 0x4) {
+                // add/or/xor with x0 copy the other operand.
+                if (funct3 == 0x4 && rs1 == rs2)
+                    is_zero = true;
+                else if (rs1 == 0 && rs2 == 0)
+                    is_zero = true;
+                else if (rs2 == 0)
+                    move_src = rs1;
+                else if (rs1 == 0)
+                    move_src = rs2;
+            } else if (funct3 == 0x7 && (rs1 == 0 || rs2 == 0)) {
+                is_zero = true;
+            }
+        } else if (opcode == 0x33 && funct7 == 0x20 && funct3 == 0x0) {
+            // sub rd, rs, rs is zero; sub rd, rs, x0 copies rs.
+            if (rs1 == rs2)
+                is_zero = true;
+            else if (rs2 == 0)
+                move_src = rs1;
+        }
+    } else {
+        uint16_t c_inst = machine_inst & 0xffff;
+        int c_rs2 = (c_inst >> 2) & 0x1f;
+        if ((c_inst & 0x3) == 0x2 && (c_inst >> 12) == 0x8 && c_rs2 != 0) {
+            // c.mv rd, rs2
+            move_src = c_rs2;
+        } else if ((c_inst & 0x3) == 0x1 && (c_inst >> 13) == 0x2 &&
+                   !(c_inst & 0x107c)) {
+            // c.li rd, 0
+            is_zero = true;
+        }
+    }
+}
+
+} // anonymous namespace
+
+bool
+Rename::eliminateIdiom(const DynInstPtr &inst, ThreadID tid)
+{
+    // Only plain single-destination integer ALU ops qualify. Fused pairs
+    // keep their shared IQ entry, so neither half is eliminated.
+    if (inst->opClass() != IntAluOp || inst->numDestRegs() != 1 ||
+        inst->isControl() || inst->isMemRef() || inst->isMicroop() ||
+        inst->isSerializing() || inst->isNonSpeculative() ||
+        inst->isFusedHead() || inst->isFusedTail()) {
+        return false;
+    }
+
+    const RegId &dest_reg = inst->destRegIdx(0);
+    if (dest_reg.classValue() != IntRegClass ||
+        dest_reg.getNumPinnedWrites() != 0) {
+        return false;
+    }
+
+    // x0 is never renamed, so a zero source register shows up as
+    // register number 0 here.
+    bool is_zero = false;
+    int move_src = -1;
+    decodeRiscvIdiom(inst->staticInst->getRawInst(), is_zero, move_src);
+
+    PhysRegIdPtr shared_reg = nullptr;
+    if (is_zero) {
+        shared_reg = zeroReg;
+    } else if (move_src > 0) {
+        for (int src_idx = 0; src_idx < inst->numSrcRegs(); src_idx++) {
+            const RegId &src_reg = inst->srcRegIdx(src_idx);
+            if (src_reg.classValue() == IntRegClass &&
+                src_reg.index() == move_src) {
+                shared_reg = inst->renamedSrcIdx(src_idx);
+                break;
+            }
+        }
+    }
+
+    if (!shared_reg || shared_reg->getNumPinnedWrites() != 0)
+        return false;
+
+    gem5::ThreadContext *tc = inst->tcBase();
+    RegId flat_dest_regid = dest_reg.flatten(*tc->getIsaPtr());
+
+    UnifiedRenameMap::RenameInfo rename_result =
+        renameMap[tid]->renameShared(flat_dest_regid, shared_reg);
+
+    inst->flattenedDestIdx(0, flat_dest_regid);
+
+    // The shared register keeps its scoreboard state: it is either
+    // already ready or will be set by its own producer.
+    DPRINTF(Rename, "[tid:%i] [sn:%llu] Eliminated %s, arch reg %i (%s) "
+            "shares physical reg %i (%i).\n",
+            tid, inst->seqNum, is_zero ? "zero idiom" : "move",
+            dest_reg.index(), dest_reg.className(),
+            rename_result.first->index(), rename_result.first->flatIndex());
+
+    RenameHistory hb_entry(inst->seqNum, flat_dest_regid,
+                           rename_result.first,
+                           rename_result.second);
+
+    historyBuffer[tid].push_front(hb_entry);
+
+    inst->renameDestReg(0, rename_result.first, rename_result.second);
+    inst->setEliminated();
+
+    ++stats.renamedOperands;
+    if (is_zero)
+        ++stats.zeroIdiomsEliminated;
+    else
+        ++stats.movesEliminated;
+
+    return true;
+}
+
+void
+Rename::recordRenamedStore(const DynInstPtr &inst, ThreadID tid)
+{
+    // Which source holds the data is learnt by the predictor, so keep
+    // every integer source a load could be paired with.
+    RenamedStore store{inst->seqNum, inst->pcState().instAddr(), {}};
+    for (int src_idx = 0; src_idx < inst->numSrcRegs(); src_idx++) {
+        PhysRegIdPtr phys_reg = inst->renamedSrcIdx(src_idx);
+        bool usable = inst->srcRegIdx(src_idx).classValue() == IntRegClass &&
+            phys_reg->getNumPinnedWrites() == 0;
+        store.srcRegs.push_back(usable ? phys_reg : nullptr);
+    }
+
+    renamedStores[tid].push_back(store);
+}
+
+void
+Rename::releaseEarly(ThreadID tid)
+{
+    if (historyBuffer[tid].empty())
+        return;
+
+    // Only renamed instructions are looked at, and none past the oldest
+    // branch that may still squash. Collect the registers that those
+    // not yet executed have still to read.
+    InstSeqNum youngest_renamed = historyBuffer[tid].front().instSeqNum;
+    InstSeqNum unresolved = youngest_renamed + 1;
+    std::unordered_set<RegIndex> pending_reads;
+
+    for (const auto &inst : cpu->instList) {
+        if (inst->seqNum > youngest_renamed)
+            break;
+        if (inst->threadNumber != tid || inst->isSquashed())
+            continue;
+
+        if (inst->isControl() &&
+            (!inst->isExecuted() || inst->mispredicted())) {
+            unresolved = inst->seqNum;
+            break;
+        }
+
+        // Branches and DVR chain instructions read their sources again
+        // at writeback or commit, for branch runahead and the chain
+        // decoder, so those are pending until the reader commits.
+        bool late_reader = inst->isDirectCtrl() ||
+            cpu->taintScoreboard.isChainPC(inst->pcState().instAddr());
+
+        if (!inst->isExecuted() || (late_reader && !inst->isCommitted())) {
+            for (int i = 0; i < inst->numSrcRegs(); i++)
+                pending_reads.insert(inst->renamedSrcIdx(i)->flatIndex());
+        }
+    }
+
+    // Walk the history oldest first. A previous register is only
+    // released once its own producer has committed, which leaves it as
+    // the committed mapping that a squash restores.
+    std::unordered_set<RegIndex> inflight_regs;
+    for (auto hb_it = historyBuffer[tid].rbegin();
+         hb_it != historyBuffer[tid].rend() &&
+         hb_it->instSeqNum < unresolved; ++hb_it) {
+        PhysRegIdPtr prev_reg = hb_it->prevPhysReg;
+
+        if (hb_it->canRelease && !hb_it->released &&
+            prev_reg != zeroReg &&
+            !inflight_regs.count(prev_reg->flatIndex()) &&
+            !pending_reads.count(prev_reg->flatIndex()) &&
+            !freeList->numReferences(prev_reg) &&
+            std::none_of(renamedStores[tid].begin(),
+                         renamedStores[tid].end(),
+                         [prev_reg](const RenamedStore &store)
+                         { return std::count(store.srcRegs.begin(),
+                                             store.srcRegs.end(),
+                                             prev_reg); })) {
+            DPRINTF(Rename, "[tid:%i] [sn:%llu] Releasing phys reg %i (%s) "
+                    "at its last use.\n", tid, hb_it->instSeqNum,
+                    prev_reg->index(), prev_reg->className());
+
+            hb_it->savedValue = cpu->getReg(prev_reg, tid);
+            hb_it->released = true;
+            freeList->addReg(prev_reg);
+
+            ++stats.earlyReleases;
+        }
+
+        inflight_regs.insert(hb_it->newPhysReg->flatIndex());
+    }
+}
+
+void
+Rename::restoreReleased(const RenameHistory &hb_entry, ThreadID tid)
+{
+    // The previous register is gone, so its value is put back in the
+    // redefiner's register, which takes its place as both the
+    // speculative and the committed mapping.
+    DPRINTF(Rename, "[tid:%i] Restoring early released value %#x in phys "
+            "reg %i.\n", tid, hb_entry.savedValue,
+            hb_entry.newPhysReg->index());
+
+    renameMap[tid]->setEntry(hb_entry.archReg, hb_entry.newPhysReg);
+    cpu->remapCommittedReg(hb_entry.archReg, hb_entry.newPhysReg, tid);
+    cpu->setReg(hb_entry.newPhysReg, hb_entry.savedValue, tid);
+    scoreboard->setReg(hb_entry.newPhysReg);
+}
+
+void
+Rename::restoreReleasedRegs(ThreadID tid)
+{
+    if (!earlyRegRelease)
+        return;
+
+    for (const auto &hb_entry : historyBuffer[tid]) {
+        if (hb_entry.released)
+            restoreReleased(hb_entry, tid);
+    }
+}
+
+bool
+Rename::renameLoadFromStore(const DynInstPtr &inst, ThreadID tid)
+{
+    if (!inst->isLoad() || inst->numDestRegs() != 1 ||
+        inst->isMicroop() || inst->isSerializing() ||
+        inst->isNonSpeculative() || inst->isFusedHead() ||
+        inst->isFusedTail() || renamedStores[tid].empty()) {
+        return false;
+    }
+
+    const RegId &dest_reg = inst->destRegIdx(0);
+    Addr load_pc = inst->pcState().instAddr();
+    if (dest_reg.classValue() != IntRegClass ||
+        dest_reg.getNumPinnedWrites() != 0 ||
+        cpu->isStridePC(load_pc)) {
+        return false;
+    }
+
+    // The predictor only pairs loads that read back a whole register
+    // stored by the store, and says which store source that register is.
+    Addr store_pc;
+    int data_idx;
+    if (!cpu->getLSQ().memRenamePred.lookup(load_pc, store_pc, data_idx))
+        return false;
+
+    // Pair the load with the youngest in-flight instance of the store.
+    PhysRegIdPtr shared_reg = nullptr;
+    for (auto it = renamedStores[tid].rbegin();
+         it != renamedStores[tid].rend(); ++it) {
+        if (it->pc == store_pc) {
+            if (data_idx < (int)it->srcRegs.size())
+                shared_reg = it->srcRegs[data_idx];
+            break;
+        }
+    }
+
+    if (!shared_reg)
+        return false;
+
+    gem5::ThreadContext *tc = inst->tcBase();
+    RegId flat_dest_regid = dest_reg.flatten(*tc->getIsaPtr());
+
+    UnifiedRenameMap::RenameInfo rename_result =
+        renameMap[tid]->renameShared(flat_dest_regid, shared_reg);
+
+    inst->flattenedDestIdx(0, flat_dest_regid);
+
+    // As with eliminated moves, the shared register keeps its scoreboard
+    // state and is made ready by the instruction producing the store data.
+    DPRINTF(Rename, "[tid:%i] [sn:%llu] Memory renamed load PC %#x to "
+            "store PC %#x, arch reg %i (%s) shares physical reg %i (%i).\n",
+            tid, inst->seqNum, load_pc, store_pc,
+            dest_reg.index(), dest_reg.className(),
+            rename_result.first->index(), rename_result.first->flatIndex());
+
+    RenameHistory hb_entry(inst->seqNum, flat_dest_regid,
+                           rename_result.first,
+                           rename_result.second);
+
+    historyBuffer[tid].push_front(hb_entry);
+
+    inst->renameDestReg(0, rename_result.first, rename_result.second);
+    inst->setMemRenamed();
+
+    ++stats.renamedOperands;
+    ++stats.memRenamedLoads;
+
+    return true;
+}
+
+void
+Rename::takeCheckpoint(const DynInstPtr &inst, ThreadID tid)
+{
+    Addr branch_pc = inst->pcState().instAddr();
+    if (!branchConf.isLowConfidence(branch_pc))
+        return;
+
+    if (checkpoints[tid].size() >= numCheckpoints) {
+        ++stats.checkpointsUnavailable;
+        return;
+    }
+
+    DPRINTF(Rename, "[tid:%i] [sn:%llu] Checkpointing rename map at low "
+            "confidence branch PC %#x.\n", tid, inst->seqNum, branch_pc);
+
+    checkpoints[tid].push_back({inst->seqNum, branch_pc, *renameMap[tid]});
+
+    ++stats.checkpointsTaken;
+}
+
 int
 Rename::calcFreeROBEntries(ThreadID tid)
 {
     int num_free = freeEntries[tid].robEntries -
-                  (instsInProgress[tid] - fromIEW->iewInfo[tid].dispatched);
+                  (instsInProgress[tid] - fromIEW->iewInfo[tid].dispatched) -
+                  cpu->smtPartitioner.reservedEntries(
+                          SMTPartitioner::ROBRes, tid);
 
     //DPRINTF(Rename,"[tid:%i] %i rob free\n",tid,num_free);
 
@@ -1168,7 +1738,9 @@ int
 Rename::calcFreeIQEntries(ThreadID tid)
 {
     int num_free = freeEntries[tid].iqEntries -
-                  (instsInProgress[tid] - fromIEW->iewInfo[tid].dispatched);
+                  (instsInProgress[tid] - fromIEW->iewInfo[tid].dispatched) -
+                  cpu->smtPartitioner.reservedEntries(
+                          SMTPartitioner::IQRes, tid);
 
     //DPRINTF(Rename,"[tid:%i] %i iq free\n",tid,num_free);
 
@@ -1179,7 +1751,8 @@ int
 Rename::calcFreeLQEntries(ThreadID tid)
 {
         int num_free = freeEntries[tid].lqEntries -
-            (loadsInProgress[tid] - fromIEW->iewInfo[tid].dispatchedToLQ);
+            (loadsInProgress[tid] - fromIEW->iewInfo[tid].dispatchedToLQ) -
+            cpu->smtPartitioner.reservedEntries(SMTPartitioner::LQRes, tid);
         DPRINTF(Rename,
                 "calcFreeLQEntries: free lqEntries: %d, loadsInProgress: %d, "
                 "loads dispatchedToLQ: %d\n",
@@ -1192,7 +1765,8 @@ int
 Rename::calcFreeSQEntries(ThreadID tid)
 {
         int num_free = freeEntries[tid].sqEntries -
-            (storesInProgress[tid] - fromIEW->iewInfo[tid].dispatchedToSQ);
+            (storesInProgress[tid] - fromIEW->iewInfo[tid].dispatchedToSQ) -
+            cpu->smtPartitioner.reservedEntries(SMTPartitioner::SQRes, tid);
         DPRINTF(Rename, "calcFreeSQEntries: free sqEntries: %d, "
                 "storesInProgress: %d, stores dispatchedToSQ: %d\n",
                 freeEntries[tid].sqEntries, storesInProgress[tid],
@@ -1234,15 +1808,22 @@ Rename::checkStall(ThreadID tid)
     if (stalls[tid].iew) {
         DPRINTF(Rename,"[tid:%i] Stall from IEW stage detected.\n", tid);
         ret_val = true;
-    } else if (calcFreeROBEntries(tid) <= 0) {
+    } else if (calcFreeROBEntries(tid) <= 0 &&
+               !cpu->preciseRunahead.isActive(tid)) {
+        // A full ROB is what starts Precise Runahead, which renames past it.
         DPRINTF(Rename,"[tid:%i] Stall: ROB has 0 free entries.\n", tid);
         ret_val = true;
     } else if (calcFreeIQEntries(tid) <= 0) {
         DPRINTF(Rename,"[tid:%i] Stall: IQ has 0 free entries.\n", tid);
         ret_val = true;
-    } else if (calcFreeLQEntries(tid) <= 0 && calcFreeSQEntries(tid) <= 0) {
+    } else if (calcFreeLQEntries(tid) <= 0 && calcFreeSQEntries(tid) <= 0 &&
+               !cpu->preciseRunahead.isActive(tid)) {
         DPRINTF(Rename,"[tid:%i] Stall: LSQ has 0 free entries.\n", tid);
         ret_val = true;
+    } else if (cpu->curCycle() < walkDoneCycle[tid]) {
+        DPRINTF(Rename,"[tid:%i] Stall: walking the history buffer after "
+                "a squash.\n", tid);
+        ret_val = true;
     } else if (renameStatus[tid] == SerializeStall &&
                (!emptyROB[tid] || instsInProgress[tid])) {
         DPRINTF(Rename,"[tid:%i] Stall: Serialize stall and ROB is not "
@@ -1311,8 +1892,22 @@ Rename::checkSignalsAndUpdate(ThreadID tid)
         DPRINTF(Rename, "[tid:%i] Squashing instructions due to squash from "
                 "commit.\n", tid);
 
+        if (fromCommit->commitInfo[tid].mispredictInst) {
+            branchConf.trainMispredict(fromCommit->commitInfo[tid].
+                    mispredictInst->pcState().instAddr());
+        }
+
         squash(fromCommit->commitInfo[tid].doneSeqNum, tid);
 
+        // The mispredicted branch survives the squash but must not be
+        // trained correct when it commits.
+        if (fromCommit->commitInfo[tid].mispredictInst &&
+            !renamedBranches[tid].empty() &&
+            renamedBranches[tid].back().seqNum ==
+            fromCommit->commitInfo[tid].mispredictInst->seqNum) {
+            renamedBranches[tid].pop_back();
+        }
+
         return true;
     } else if (!fromCommit->commitInfo[tid].robSquashing &&
             !freeingInProgress[tid].empty()) {
@@ -42,10 +42,13 @@
 #ifndef __CPU_O3_RENAME_HH__
 #define __CPU_O3_RENAME_HH__
 
+#include <deque>
 #include <list>
 #include <utility>
+#include <vector>
 
 #include "base/statistics.hh"
+#include "cpu/o3/branch_conf.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/commit.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
@@ -175,6 +178,11 @@ class Rename
     /** Sets pointer to the free list. */
     void setFreeList(UnifiedFreeList *fl_ptr);
 
+    /** Sets the always-zero physical register that eliminated zero
+     * idioms are mapped to.
+     */
+    void setZeroReg(PhysRegIdPtr zero_reg) { zeroReg = zero_reg; }
+
     /** Sets pointer to the scoreboard. */
     void setScoreboard(Scoreboard *_scoreboard);
 
@@ -190,6 +198,18 @@ class Rename
     /** Squashes all instructions in a thread. */
     void squash(const InstSeqNum &squash_seq_num, ThreadID tid);
 
+    /** Returns whether a squash back to the given instruction can restore
+     * the rename map from a checkpoint instead of walking the history.
+     */
+    bool hasCheckpoint(InstSeqNum seq_num, ThreadID tid) const;
+
+    /** Puts every early released value of a thread back in its
+     * redefiner's register and maps it as committed state, so a trap
+     * reading the thread context sees the right values. The squash that
+     * follows the trap restores them again.
+     */
+    void restoreReleasedRegs(ThreadID tid);
+
     /** Ticks rename, which processes all input signals and attempts to rename
      * as many instructions as possible.
      */
@@ -248,12 +268,52 @@ class Rename
     /** Removes a committed instruction's rename history. */
     void removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid);
 
+    /**
+     * Frees the previous physical registers of redefinitions that no
+     * older branch can squash and whose readers have all executed,
+     * without waiting for the redefiner to commit. The freed value is
+     * kept in the history entry, so a squash from a fault or memory order
+     * violation can still put it back.
+     */
+    void releaseEarly(ThreadID tid);
+
+    /** Checkpoints the rename map after a low confidence branch, if a
+     * checkpoint is free. Must be called after the branch's destination
+     * registers have been renamed.
+     */
+    void takeCheckpoint(const DynInstPtr &inst, ThreadID tid);
+
     /** Renames the source registers of an instruction. */
     void renameSrcRegs(const DynInstPtr &inst, ThreadID tid);
 
     /** Renames the destination registers of an instruction. */
     void renameDestRegs(const DynInstPtr &inst, ThreadID tid);
 
+    /**
+     * Tries to eliminate a register move or zero idiom by mapping its
+     * destination onto the source's (or the zero) physical register
+     * instead of allocating a new one. Must be called after the source
+     * registers have been renamed.
+     * @return Whether the instruction was eliminated; if so its
+     * destination has been renamed and recorded in the history buffer.
+     */
+    bool eliminateIdiom(const DynInstPtr &inst, ThreadID tid);
+
+    /** Records a store whose data register may later be shared with a
+     * load that the memory renaming predictor pairs it with.
+     */
+    void recordRenamedStore(const DynInstPtr &inst, ThreadID tid);
+
+    /**
+     * Tries to rename a load's destination onto the data register of the
+     * in-flight store that the memory renaming predictor expects it to
+     * read from. The load still executes, and IEW checks the value it
+     * loads against the shared register.
+     * @return Whether the load was renamed; if so its destination has
+     * been renamed and recorded in the history buffer.
+     */
+    bool renameLoadFromStore(const DynInstPtr &inst, ThreadID tid);
+
     /** Calculates the number of free ROB entries for a specific thread. */
     int calcFreeROBEntries(ThreadID tid);
 
@@ -298,9 +358,11 @@ class Rename
     {
         RenameHistory(InstSeqNum _instSeqNum, const RegId& _archReg,
                       PhysRegIdPtr _newPhysReg,
-                      PhysRegIdPtr _prevPhysReg)
+                      PhysRegIdPtr _prevPhysReg,
+                      bool _canRelease = false)
             : instSeqNum(_instSeqNum), archReg(_archReg),
-              newPhysReg(_newPhysReg), prevPhysReg(_prevPhysReg)
+              newPhysReg(_newPhysReg), prevPhysReg(_prevPhysReg),
+              canRelease(_canRelease)
         {
         }
 
@@ -313,6 +375,14 @@ class Rename
         /** The old physical register that the arch. register was renamed to.
          */
         PhysRegIdPtr prevPhysReg;
+        /** Whether prevPhysReg may be released before the rename commits;
+         * only for scalar registers renamed onto a fresh register.
+         */
+        bool canRelease;
+        /** Whether prevPhysReg has already been released. */
+        bool released = false;
+        /** Value prevPhysReg held when it was released. */
+        RegVal savedValue = 0;
     };
 
     /** A per-thread list of all destination register renames, used to either
@@ -320,6 +390,9 @@ class Rename
      */
     std::list<RenameHistory> historyBuffer[MaxThreads];
 
+    /** Restores the early released value of a history entry. */
+    void restoreReleased(const RenameHistory &hb_entry, ThreadID tid);
+
     /** Pointer to CPU. */
     CPU *cpu;
 
@@ -359,6 +432,70 @@ class Rename
     /** Free list interface. */
     UnifiedFreeList *freeList;
 
+    /** Physical register permanently holding zero, used as the
+     * destination of eliminated zero idioms.
+     */
+    PhysRegIdPtr zeroReg;
+
+    /** Whether register moves and zero idioms are eliminated. */
+    bool moveElimination;
+
+    /** Whether loads are renamed onto the data register of a predicted
+     * store.
+     */
+    bool memRenaming;
+
+    /** Whether physical registers are released at their last use. */
+    bool earlyRegRelease;
+
+    /** An in-flight store that loads may be memory renamed to. */
+    struct RenamedStore
+    {
+        InstSeqNum seqNum;
+        Addr pc;
+        /** Renamed source registers, or nullptr for those that cannot be
+         * shared with a load.
+         */
+        std::vector<PhysRegIdPtr> srcRegs;
+    };
+
+    /** In-flight stores in program order, per thread. */
+    std::deque<RenamedStore> renamedStores[MaxThreads];
+
+    /** Number of rename map checkpoints per thread; 0 disables them. */
+    unsigned numCheckpoints;
+
+    /** A copy of the rename map as it was right after a branch renamed. */
+    struct RenameCheckpoint
+    {
+        InstSeqNum seqNum;
+        Addr pc;
+        UnifiedRenameMap map;
+    };
+
+    /** Live checkpoints in program order, per thread. */
+    std::deque<RenameCheckpoint> checkpoints[MaxThreads];
+
+    /** A renamed branch whose outcome trains branchConf. */
+    struct RenamedBranch
+    {
+        InstSeqNum seqNum;
+        Addr pc;
+    };
+
+    /** In-flight branches that may take a checkpoint, in program order,
+     * per thread.
+     */
+    std::deque<RenamedBranch> renamedBranches[MaxThreads];
+
+    /** Picks the branches that are worth a checkpoint. */
+    BranchConfidence branchConf;
+
+    /** Cycle at which the history walk of the last squash that had no
+     * checkpoint to restore from is done, per thread.
+     */
+    Cycles walkDoneCycle[MaxThreads];
+
     /** Hold phys regs to be released after squash finish */
     std::vector<PhysRegIdPtr> freeingInProgress[MaxThreads];
 
@@ -445,6 +582,11 @@ class Rename
      */
     unsigned toIEWIndex;
 
+    /** Number of fused tails sent to IEW this cycle. A fused tail is
+     * renamed alongside its head and does not use up a rename slot.
+     */
+    unsigned fusedThisCycle;
+
     /** Whether or not rename needs to block this cycle. */
     bool blockThisCycle;
 
@@ -536,6 +678,35 @@ class Rename
         statistics::Scalar tempSerializing;
         /** Number of instructions inserted into skid buffers. */
         statistics::Scalar skidInsts;
+        /** Stat for total number of register moves eliminated. */
+        statistics::Scalar movesEliminated;
+        /** Stat for total number of zero idioms eliminated. */
+        statistics::Scalar zeroIdiomsEliminated;
+        /** Stat for total number of loads memory renamed to a store. */
+        statistics::Scalar memRenamedLoads;
+        /** Stat for total number of rename map checkpoints taken. */
+        statistics::Scalar checkpointsTaken;
+        /** Stat for total number of low confidence branches that found
+         *  no free checkpoint. */
+        statistics::Scalar checkpointsUnavailable;
+        /** Stat for total number of squashes recovered from a
+         *  checkpoint. */
+        statistics::Scalar checkpointRestores;
+        /** Stat for total number of history entries that did not have to
+         *  be walked thanks to a checkpoint. */
+        statistics::Scalar checkpointMapsSkipped;
+        /** Stat for the number of cycles a renameWidth-wide history walk
+         *  would have taken for the restored squashes. */
+        statistics::Scalar checkpointWalkCyclesSaved;
+        /** Stat for the number of cycles rename stalled walking the
+         *  history buffer after a squash. */
+        statistics::Scalar squashWalkCycles;
+        /** Stat for number of registers released before their redefiner
+         *  committed. */
+        statistics::Scalar earlyReleases;
+        /** Stat for number of early released values restored by a
+         *  squash. */
+        statistics::Scalar earlyReleaseRestores;
     } stats;
 };
 
@@ -111,6 +111,7 @@ UnifiedRenameMap::init(const BaseISA::RegClasses &regClasses,
         PhysRegFile *_regFile, UnifiedFreeList *freeList)
 {
     regFile = _regFile;
+    unifiedFreeList = freeList;
 
     for (int i = 0; i < renameMaps.size(); i++)
         renameMaps[i].init(*regClasses.at(i), &(freeList->freeLists[i]));
@@ -178,6 +178,9 @@ class UnifiedRenameMap
      */
     PhysRegFile *regFile;
 
+    /** The free list that keeps track of shared physical registers. */
+    UnifiedFreeList *unifiedFreeList;
+
   public:
 
     typedef SimpleRenameMap::RenameInfo RenameInfo;
@@ -185,7 +188,7 @@ class UnifiedRenameMap
     typedef std::array<UnifiedRenameMap, MaxThreads> PerThreadUnifiedRenameMap;
 
     /** Default constructor.  init() must be called prior to use. */
-    UnifiedRenameMap() : regFile(nullptr) {};
+    UnifiedRenameMap() : regFile(nullptr), unifiedFreeList(nullptr) {};
 
     /** Destructor. */
     ~UnifiedRenameMap() {};
@@ -216,6 +219,31 @@ class UnifiedRenameMap
         return renameMaps[arch_reg.classValue()].rename(arch_reg);
     }
 
+    /**
+     * Remap an architectural register onto a physical register that is
+     * already live, without taking one from the free list. Used to
+     * eliminate register moves and zero idioms. The shared register
+     * gains a reference, which is dropped again when the mapping is
+     * retired or undone through UnifiedFreeList::addReg().
+     * @param arch_reg The renameable architectural register to remap.
+     * @param phys_reg The physical register to share.
+     * @return A RenameInfo pair indicating both the new and previous
+     * physical registers.
+     */
+    RenameInfo
+    renameShared(const RegId& arch_reg, PhysRegIdPtr phys_reg)
+    {
+        assert(arch_reg.isRenameable());
+        PhysRegIdPtr prev_reg = lookup(arch_reg);
+        // Remapping a register onto itself leaves the mapping unchanged,
+        // and is treated like any other new == prev history entry.
+        if (prev_reg != phys_reg) {
+            unifiedFreeList->addReference(phys_reg);
+            setEntry(arch_reg, phys_reg);
+        }
+        return RenameInfo(phys_reg, prev_reg);
+    }
+
     /**
      * Look up the physical register mapped to an architectural register.
      * This version takes a flattened architectural register id
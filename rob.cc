@@ -40,9 +40,11 @@
 
 #include "cpu/o3/rob.hh"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/limits.hh"
@@ -62,12 +64,15 @@ ROB::ROB(CPU *_cpu, const BaseO3CPUParams &params)
       numEntries(params.numROBEntries),
       squashWidth(params.squashWidth),
       numInstsInROB(0),
+      numFusedInROB(0),
       numThreads(params.numThreads),
       stats(_cpu)
 {
     //Figure out rob policy
-    if (robPolicy == SMTQueuePolicy::Dynamic) {
-        //Set Max Entries to Total ROB Capacity
+    if (robPolicy == SMTQueuePolicy::Dynamic ||
+        robPolicy == SMTQueuePolicy::Adaptive) {
+        //Set Max Entries to Total ROB Capacity; Adaptive shares are
+        //enforced at rename
         for (ThreadID tid = 0; tid < numThreads; tid++) {
             maxEntries[tid] = numEntries;
         }
@@ -106,11 +111,14 @@ ROB::resetState()
 {
     for (ThreadID tid = 0; tid  < MaxThreads; tid++) {
         threadEntries[tid] = 0;
+        threadFused[tid] = 0;
         squashIt[tid] = instList[tid].end();
         squashedSeqNum[tid] = 0;
         doneSquashing[tid] = true;
+        checkpointSquash[tid] = false;
     }
     numInstsInROB = 0;
+    numFusedInROB = 0;
 
     // Initialize the "universal" ROB head & tail point to invalid
     // pointers
@@ -203,7 +211,7 @@ ROB::insertInst(const DynInstPtr &inst)
 
     DPRINTF(ROB, "Adding inst PC %s to the ROB.\n", inst->pcState());
 
-    assert(numInstsInROB != numEntries);
+    assert(inst->isFusedTail() || !isFull());
 
     ThreadID tid = inst->threadNumber;
 
@@ -225,6 +233,11 @@ ROB::insertInst(const DynInstPtr &inst)
     ++numInstsInROB;
     ++threadEntries[tid];
 
+    if (inst->isFusedTail()) {
+        ++numFusedInROB;
+        ++threadFused[tid];
+    }
+
     assert((*tail) == inst);
 
     DPRINTF(ROB, "[tid:%i] Now has %d instructions.\n", tid,
@@ -254,6 +267,11 @@ ROB::retireHead(ThreadID tid)
     --numInstsInROB;
     --threadEntries[tid];
 
+    if (head_inst->isFusedTail()) {
+        --numFusedInROB;
+        --threadFused[tid];
+    }
+
     Addr stride_pc = 0;
     if (cpu->isStridePC(head_inst)) {
         DPRINTF(ROB, "Instruction at PC 0x%lx is a stride load\n",
@@ -323,13 +341,23 @@ ROB::canCommit()
 unsigned
 ROB::numFreeEntries()
 {
-    return numEntries - numInstsInROB;
+    return numEntries - (numInstsInROB - numFusedInROB);
 }
 
 unsigned
 ROB::numFreeEntries(ThreadID tid)
 {
-    return maxEntries[tid] - threadEntries[tid];
+    // Rename takes off the entries held back for other threads. Shares
+    // move between epochs, so a thread whose share grew may still have to
+    // wait for another to drain its old one.
+    if (robPolicy == SMTQueuePolicy::Adaptive) {
+        return std::min<unsigned>(
+                maxEntries[tid] - (threadEntries[tid] - threadFused[tid]),
+                numFreeEntries() + cpu->smtPartitioner.reservedEntries(
+                        SMTPartitioner::ROBRes, tid));
+    }
+
+    return maxEntries[tid] - (threadEntries[tid] - threadFused[tid]);
 }
 
 void
@@ -358,7 +386,8 @@ ROB::doSquash(ThreadID tid)
     // If the CPU is exiting, squash all of the instructions
     // it is told to, even if that exceeds the squashWidth.
     // Set the number to the number of entries (the max).
-    if (cpu->isThreadExiting(tid))
+    // The same goes for squashes that rename recovers from a checkpoint.
+    if (cpu->isThreadExiting(tid) || checkpointSquash[tid])
     {
         numInstsToSquash = numEntries;
     }
@@ -497,7 +526,7 @@ ROB::updateTail()
 
 
 void
-ROB::squash(InstSeqNum squash_num, ThreadID tid)
+ROB::squash(InstSeqNum squash_num, ThreadID tid, bool from_checkpoint)
 {
     if (isEmpty(tid)) {
         DPRINTF(ROB, "Does not need to squash due to being empty "
@@ -515,6 +544,26 @@ ROB::squash(InstSeqNum squash_num, ThreadID tid)
 
     squashedSeqNum[tid] = squash_num;
 
+    checkpointSquash[tid] = from_checkpoint;
+
+    if (from_checkpoint) {
+        unsigned num_to_squash = 0;
+        for (auto it = instList[tid].rbegin();
+             it != instList[tid].rend() && (*it)->seqNum > squash_num;
+             ++it) {
+            ++num_to_squash;
+        }
+
+        DPRINTF(ROB, "[tid:%i] Squashing %u instructions at once from a "
+                "rename checkpoint.\n", tid, num_to_squash);
+
+        stats.checkpointSquashes++;
+        if (num_to_squash > squashWidth) {
+            stats.checkpointSquashCyclesSaved +=
+                divCeil(num_to_squash, squashWidth) - 1;
+        }
+    }
+
     if (!instList[tid].empty()) {
         InstIt tail_thread = instList[tid].end();
         tail_thread--;
@@ -553,8 +602,14 @@ ROB::ROBStats::ROBStats(statistics::Group *parent)
     ADD_STAT(reads, statistics::units::Count::get(),
         "The number of ROB reads"),
     ADD_STAT(writes, statistics::units::Count::get(),
-        "The number of ROB writes")
+        "The number of ROB writes"),
+    ADD_STAT(checkpointSquashes, statistics::units::Count::get(),
+        "The number of squashes recovered from a rename checkpoint"),
+    ADD_STAT(checkpointSquashCyclesSaved, statistics::units::Cycle::get(),
+        "The number of squash cycles saved by rename checkpoints")
 {
+    checkpointSquashes.prereq(checkpointSquashes);
+    checkpointSquashCyclesSaved.prereq(checkpointSquashCyclesSaved);
 }
 
 DynInstPtr
@@ -180,15 +180,15 @@ class ROB
 
     /** Returns the number of entries being used by a specific thread. */
     unsigned getThreadEntries(ThreadID tid)
-    { return threadEntries[tid]; }
+    { return threadEntries[tid] - threadFused[tid]; }
 
     /** Returns if the ROB is full. */
     bool isFull()
-    { return numInstsInROB == numEntries; }
+    { return numInstsInROB - numFusedInROB == numEntries; }
 
     /** Returns if a specific thread's partition is full. */
     bool isFull(ThreadID tid)
-    { return threadEntries[tid] == numEntries; }
+    { return threadEntries[tid] - threadFused[tid] == numEntries; }
 
     /** Returns if the ROB is empty. */
     bool isEmpty() const
@@ -203,8 +203,11 @@ class ROB
 
     /** Squashes all instructions younger than the given sequence number for
      *  the specific thread.
+     *  @param from_checkpoint Whether the squash recovers from a rename map
+     *  checkpoint, in which case it is not limited by the squash width.
      */
-    void squash(InstSeqNum squash_num, ThreadID tid);
+    void squash(InstSeqNum squash_num, ThreadID tid,
+                bool from_checkpoint = false);
 
     /** Updates the head instruction with the new oldest instruction. */
     void updateHead();
@@ -282,6 +285,11 @@ class ROB
     /** Entries Per Thread */
     unsigned threadEntries[MaxThreads];
 
+    /** Fused tails per thread. These share their head's entry, so they
+     * are in the instruction list but do not take up ROB capacity.
+     */
+    unsigned threadFused[MaxThreads];
+
     /** Max Insts a Thread Can Have in the ROB */
     unsigned maxEntries[MaxThreads];
 
@@ -316,6 +324,9 @@ class ROB
     /** Number of instructions in the ROB. */
     int numInstsInROB;
 
+    /** Number of fused tails in the ROB. */
+    int numFusedInROB;
+
     /** Dummy instruction returned if there are no insts left. */
     DynInstPtr dummyInst;
 
@@ -326,6 +337,9 @@ class ROB
     /** Is the ROB done squashing. */
     bool doneSquashing[MaxThreads];
 
+    /** Whether the current squash recovers from a rename map checkpoint. */
+    bool checkpointSquash[MaxThreads];
+
     /** Number of active threads. */
     ThreadID numThreads;
 
@@ -338,6 +352,10 @@ class ROB
         statistics::Scalar reads;
         // The number of rob_writes
         statistics::Scalar writes;
+        // The number of squashes done in one cycle from a checkpoint
+        statistics::Scalar checkpointSquashes;
+        // The squash-width limited cycles those squashes would have taken
+        statistics::Scalar checkpointSquashCyclesSaved;
     } stats;
 };
 
@@ -0,0 +1,110 @@
+#include "cpu/o3/runahead.hh"
+
+#include "base/trace.hh"
+#include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst.hh"
+#include "debug/Runahead.hh"
+#include "params/BaseO3CPU.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+PreciseRunahead::PreciseRunahead(CPU *_cpu, const BaseO3CPUParams &params)
+    : stats(_cpu),
+      cpu(_cpu),
+      _enabled(params.runaheadEngine == RunaheadEngine::PRE)
+{
+    for (ThreadID tid = 0; tid < MaxThreads; tid++) {
+        active[tid] = false;
+        stallSeqNum[tid] = 0;
+        entryCycle[tid] = Cycles(0);
+    }
+}
+
+void
+PreciseRunahead::enter(ThreadID tid, const DynInstPtr &stalling_load)
+{
+    assert(_enabled && !active[tid]);
+
+    DPRINTF(Runahead, "[tid:%i] Entering runahead behind load [sn:%llu] "
+            "PC %s.\n", tid, stalling_load->seqNum,
+            stalling_load->pcState());
+
+    cpu->taintScoreboard.markStallingLoad(
+            stalling_load->pcState().instAddr());
+
+    active[tid] = true;
+    stallSeqNum[tid] = stalling_load->seqNum;
+    entryCycle[tid] = cpu->curCycle();
+
+    ++stats.entries;
+}
+
+void
+PreciseRunahead::exit(ThreadID tid)
+{
+    if (!active[tid])
+        return;
+
+    DPRINTF(Runahead, "[tid:%i] Leaving runahead after %llu cycles.\n",
+            tid, cpu->curCycle() - entryCycle[tid]);
+
+    stats.cycles += cpu->curCycle() - entryCycle[tid];
+    active[tid] = false;
+}
+
+bool
+PreciseRunahead::renameInst(const DynInstPtr &inst)
+{
+    inst->setRunahead();
+
+    if (inst->isControl() || inst->isStore() || inst->isAtomic() ||
+        inst->isNonSpeculative() || inst->isSerializeBefore() ||
+        inst->isSerializeAfter() || inst->isReadBarrier() ||
+        inst->isWriteBarrier() ||
+        inst->isMicroop() || inst->isFusedHead() || inst->isFusedTail() ||
+        !cpu->taintScoreboard.isSlicePC(inst->pcState().instAddr())) {
+        ++stats.droppedInsts;
+        return false;
+    }
+
+    DPRINTF(Runahead, "[tid:%i] Dispatching slice inst [sn:%llu] PC %s.\n",
+            inst->threadNumber, inst->seqNum, inst->pcState());
+
+    ++stats.sliceInsts;
+    return true;
+}
+
+PreciseRunahead::PreciseRunaheadStats::PreciseRunaheadStats(
+        statistics::Group *parent)
+    : statistics::Group(parent, "preciseRunahead"),
+      ADD_STAT(entries, statistics::units::Count::get(),
+               "Number of times a full window stall entered runahead"),
+      ADD_STAT(cycles, statistics::units::Cycle::get(),
+               "Number of cycles spent running ahead"),
+      ADD_STAT(sliceInsts, statistics::units::Count::get(),
+               "Number of slice instructions dispatched in runahead"),
+      ADD_STAT(droppedInsts, statistics::units::Count::get(),
+               "Number of instructions dropped at rename in runahead"),
+      ADD_STAT(prefetches, statistics::units::Count::get(),
+               "Number of runahead slice loads sent to the cache"),
+      ADD_STAT(droppedLoads, statistics::units::Count::get(),
+               "Number of runahead slice loads that could not be sent"),
+      ADD_STAT(cyclesPerEntry, statistics::units::Rate<
+                    statistics::units::Cycle, statistics::units::Count>::get(),
+               "Average number of cycles per runahead interval",
+               cycles / entries)
+{
+    cycles.prereq(cycles);
+    sliceInsts.prereq(sliceInsts);
+    droppedInsts.prereq(droppedInsts);
+    prefetches.prereq(prefetches);
+    droppedLoads.prereq(droppedLoads);
+    cyclesPerEntry.precision(2);
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,99 @@
+#ifndef __CPU_O3_RUNAHEAD_HH__
+#define __CPU_O3_RUNAHEAD_HH__
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/limits.hh"
+
+namespace gem5
+{
+
+struct BaseO3CPUParams;
+
+namespace o3
+{
+
+class CPU;
+
+/**
+ * Precise Runahead Execution, selected with runaheadEngine=PRE as an
+ * alternative to DVR. See "Precise Runahead Execution" by Naithani et al.
+ *
+ * When a thread's ROB is full behind a load that is still waiting on
+ * memory, the thread keeps fetching and renaming past the ROB. Only
+ * instructions on the backward slice of a load are dispatched; they use
+ * the IQ entries and physical registers left free by the stalled window,
+ * never enter the ROB, and their loads prefetch into the cache without
+ * taking LSQ entries. Everything else is dropped at rename. When the
+ * stalling load completes, the runahead instructions are squashed and
+ * fetch resumes right after the ROB tail, so the window itself is never
+ * flushed. Slices are learnt by the TaintScoreboard.
+ */
+class PreciseRunahead
+{
+  public:
+    PreciseRunahead(CPU *_cpu, const BaseO3CPUParams &params);
+
+    /** Whether Precise Runahead is the selected runahead engine. */
+    bool enabled() const { return _enabled; }
+
+    /** Whether a thread is currently running ahead. */
+    bool isActive(ThreadID tid) const { return active[tid]; }
+
+    /** Sequence number of the load a thread is running ahead of. */
+    InstSeqNum stallingLoad(ThreadID tid) const { return stallSeqNum[tid]; }
+
+    /** Enters runahead for a thread whose ROB is full behind the given
+     * load, which becomes the root of a slice.
+     */
+    void enter(ThreadID tid, const DynInstPtr &stalling_load);
+
+    /** Leaves runahead for a thread. */
+    void exit(ThreadID tid);
+
+    /**
+     * Marks an instruction renamed during runahead and returns whether it
+     * is dispatched. Instructions off the load slices, and those that
+     * cannot run outside the ROB (control, stores, serializing and
+     * non-speculative instructions), are dropped.
+     */
+    bool renameInst(const DynInstPtr &inst);
+
+    struct PreciseRunaheadStats : public statistics::Group
+    {
+        PreciseRunaheadStats(statistics::Group *parent);
+
+        /** Stat for the number of times runahead was entered. */
+        statistics::Scalar entries;
+        /** Stat for the number of cycles spent running ahead. */
+        statistics::Scalar cycles;
+        /** Stat for the number of slice instructions dispatched. */
+        statistics::Scalar sliceInsts;
+        /** Stat for the number of instructions dropped at rename. */
+        statistics::Scalar droppedInsts;
+        /** Stat for the number of slice loads sent to the cache. */
+        statistics::Scalar prefetches;
+        /** Stat for the number of slice loads that could not be sent. */
+        statistics::Scalar droppedLoads;
+        /** Average cycles per runahead interval. */
+        statistics::Formula cyclesPerEntry;
+    } stats;
+
+  private:
+    CPU *cpu;
+
+    bool _enabled;
+
+    bool active[MaxThreads];
+
+    InstSeqNum stallSeqNum[MaxThreads];
+
+    Cycles entryCycle[MaxThreads];
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_RUNAHEAD_HH__
@@ -0,0 +1,170 @@
+#include "cpu/o3/smt_partition.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "cpu/o3/cpu.hh"
+#include "debug/SMTPartition.hh"
+#include "params/BaseO3CPU.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+SMTPartitioner::SMTPartitioner(CPU *_cpu, const BaseO3CPUParams &params)
+    : stats(_cpu),
+      cpu(_cpu),
+      numThreads(params.numThreads),
+      metric(params.smtAdaptiveMetric),
+      epochLength(params.smtAdaptiveEpoch),
+      step(params.smtAdaptiveStep / 100.0),
+      trialThread(0),
+      epochStart(0)
+{
+    size[ROBRes] = params.smtROBPolicy == SMTQueuePolicy::Adaptive ?
+        params.numROBEntries : 0;
+    size[IQRes] = params.smtIQPolicy == SMTQueuePolicy::Adaptive ?
+        params.numIQEntries : 0;
+    size[LQRes] = params.smtLSQPolicy == SMTQueuePolicy::Adaptive ?
+        params.LQEntries : 0;
+    size[SQRes] = params.smtLSQPolicy == SMTQueuePolicy::Adaptive ?
+        params.SQEntries : 0;
+
+    _enabled = numThreads > 1 &&
+        std::any_of(size, size + NumResources,
+                    [](unsigned entries) { return entries != 0; });
+
+    fatal_if(_enabled && (step <= 0 || step * numThreads >= 1),
+             "smtAdaptiveStep must leave every thread a share of the "
+             "adaptive queues.\n");
+
+    for (ThreadID tid = 0; tid < MaxThreads; tid++) {
+        baseShare[tid] = tid < numThreads ? 1.0 / numThreads : 0;
+        share[tid] = baseShare[tid];
+        trialMetric[tid] = 0;
+        epochInsts[tid] = 0;
+    }
+
+    stats.favored.init(numThreads);
+
+    if (_enabled) {
+        startTrial(0);
+    } else {
+        for (int res = 0; res < NumResources; res++)
+            std::fill(reserved[res], reserved[res] + MaxThreads, 0);
+    }
+}
+
+void
+SMTPartitioner::tick()
+{
+    if (cpu->curCycle() - epochStart < epochLength)
+        return;
+
+    ++stats.epochs;
+    trialMetric[trialThread] = epochMetric();
+
+    DPRINTF(SMTPartition, "Epoch favoring [tid:%i] ended, metric %f.\n",
+            trialThread, trialMetric[trialThread]);
+
+    for (ThreadID tid = 0; tid < numThreads; tid++)
+        epochInsts[tid] = 0;
+    epochStart = cpu->curCycle();
+
+    if (++trialThread < numThreads) {
+        startTrial(trialThread);
+        return;
+    }
+
+    // Every thread had its trial; climb towards the best one.
+    ThreadID best = std::max_element(trialMetric,
+                                     trialMetric + numThreads) - trialMetric;
+    startTrial(best);
+    std::copy(share, share + numThreads, baseShare);
+
+    ++stats.rounds;
+    ++stats.favored[best];
+
+    DPRINTF(SMTPartition, "Round won by [tid:%i], its share is now %f.\n",
+            best, baseShare[best]);
+
+    trialThread = 0;
+    startTrial(trialThread);
+}
+
+double
+SMTPartitioner::epochMetric() const
+{
+    double cycles = cpu->curCycle() - epochStart;
+
+    if (metric == SMTPartitionMetric::Throughput) {
+        uint64_t insts = 0;
+        for (ThreadID tid = 0; tid < numThreads; tid++)
+            insts += epochInsts[tid];
+        return insts / cycles;
+    }
+
+    // Harmonic mean of the thread IPCs; a starved thread scores 0.
+    double inv_sum = 0;
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        if (!epochInsts[tid])
+            return 0;
+        inv_sum += cycles / epochInsts[tid];
+    }
+    return numThreads / inv_sum;
+}
+
+void
+SMTPartitioner::startTrial(ThreadID trial)
+{
+    // Never take a thread below one step, so no thread is starved.
+    double gain = 0;
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        if (tid == trial)
+            continue;
+        double take = std::min(step / (numThreads - 1),
+                               std::max(baseShare[tid] - step, 0.0));
+        share[tid] = baseShare[tid] - take;
+        gain += take;
+    }
+    share[trial] = baseShare[trial] + gain;
+
+    updateReserved();
+}
+
+void
+SMTPartitioner::updateReserved()
+{
+    for (int res = 0; res < NumResources; res++) {
+        for (ThreadID tid = 0; tid < MaxThreads; tid++) {
+            if (!size[res] || tid >= numThreads) {
+                reserved[res][tid] = 0;
+                continue;
+            }
+
+            int cap = std::max<int>(share[tid] * size[res], 1);
+            reserved[res][tid] = size[res] - cap;
+        }
+    }
+}
+
+SMTPartitioner::SMTPartitionStats::SMTPartitionStats(
+        statistics::Group *parent)
+    : statistics::Group(parent, "smtPartition"),
+      ADD_STAT(epochs, statistics::units::Count::get(),
+               "Number of adaptive partitioning epochs measured"),
+      ADD_STAT(rounds, statistics::units::Count::get(),
+               "Number of hill-climbing rounds completed"),
+      ADD_STAT(favored, statistics::units::Count::get(),
+               "Number of rounds won by each thread's trial")
+{
+    epochs.prereq(epochs);
+    rounds.prereq(rounds);
+    favored.prereq(favored);
+}
+
+} // namespace o3
+} // namespace gem5
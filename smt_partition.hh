@@ -0,0 +1,127 @@
+#ifndef __CPU_O3_SMT_PARTITION_HH__
+#define __CPU_O3_SMT_PARTITION_HH__
+
+#include <cstdint>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/o3/limits.hh"
+#include "enums/SMTPartitionMetric.hh"
+
+namespace gem5
+{
+
+struct BaseO3CPUParams;
+
+namespace o3
+{
+
+class CPU;
+
+/**
+ * Adaptive partitioning of the ROB, IQ, LQ and SQ among SMT threads,
+ * used by every queue whose sharing policy is Adaptive. See "Learning-
+ * Based SMT Processor Resource Distribution via Hill-Climbing" by Choi
+ * and Yeung.
+ *
+ * Each thread owns a share of every adaptive queue. Execution is split
+ * into epochs; in each one, a different thread is given a step more than
+ * its share, taken evenly from the others, and the epoch's throughput (or
+ * the harmonic mean of the thread IPCs) is measured. Once every thread
+ * has had a trial epoch, the shares of the best trial become the new
+ * baseline, so the split climbs towards what the co-running mix needs.
+ *
+ * The queues themselves are sized as with the Dynamic policy; rename
+ * subtracts the entries held back for other threads when it computes the
+ * free entries a thread may use.
+ */
+class SMTPartitioner
+{
+  public:
+    /** Queues that can be partitioned adaptively. */
+    enum Resource
+    {
+        ROBRes, IQRes, LQRes, SQRes,
+        NumResources
+    };
+
+    SMTPartitioner(CPU *_cpu, const BaseO3CPUParams &params);
+
+    /** Whether any queue is partitioned adaptively. */
+    bool enabled() const { return _enabled; }
+
+    /**
+     * Returns how many entries of a queue are held back from a thread,
+     * that is the queue size minus the thread's current share of it.
+     */
+    int reservedEntries(Resource res, ThreadID tid) const
+    { return reserved[res][tid]; }
+
+    /** Counts a committed instruction towards the current epoch. */
+    void commitInst(ThreadID tid) { ++epochInsts[tid]; }
+
+    /** Ends the epoch if it has run its length. */
+    void tick();
+
+    struct SMTPartitionStats : public statistics::Group
+    {
+        SMTPartitionStats(statistics::Group *parent);
+
+        /** Stat for the number of epochs measured. */
+        statistics::Scalar epochs;
+        /** Stat for the number of hill-climbing rounds completed. */
+        statistics::Scalar rounds;
+        /** Stat for the number of rounds each thread's trial won. */
+        statistics::Vector favored;
+    } stats;
+
+  private:
+    /** Evaluates the selected metric on the epoch just ended. */
+    double epochMetric() const;
+
+    /** Sets up the shares of the trial epoch of a thread. */
+    void startTrial(ThreadID trial);
+
+    /** Recomputes the entries held back from each thread. */
+    void updateReserved();
+
+    CPU *cpu;
+
+    bool _enabled;
+
+    ThreadID numThreads;
+
+    SMTPartitionMetric metric;
+
+    /** Length of an epoch. */
+    Cycles epochLength;
+
+    /** Share moved to the trial thread, as a fraction of each queue. */
+    double step;
+
+    /** Size of each queue, or 0 if it is not partitioned adaptively. */
+    unsigned size[NumResources];
+
+    /** Baseline share of each thread. */
+    double baseShare[MaxThreads];
+
+    /** Share of each thread in the current epoch. */
+    double share[MaxThreads];
+
+    int reserved[NumResources][MaxThreads];
+
+    /** Thread whose trial the current epoch is. */
+    ThreadID trialThread;
+
+    /** Metric measured for each thread's trial this round. */
+    double trialMetric[MaxThreads];
+
+    Cycles epochStart;
+
+    uint64_t epochInsts[MaxThreads];
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_SMT_PARTITION_HH__
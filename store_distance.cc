@@ -0,0 +1,107 @@
+#include "cpu/o3/store_distance.hh"
+
+#include <algorithm>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/StoreSet.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+StoreDistance::StoreDistance(uint64_t clear_period, int table_size,
+                             unsigned max_distance)
+    : distanceTable(table_size, 0), clearPeriod(clear_period),
+      maxDistance(max_distance), indexMask(table_size - 1)
+{
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid store distance table size!\n");
+    }
+
+    DPRINTF(StoreSet, "StoreDistance: table size: %i, max distance: %i.\n",
+            table_size, maxDistance);
+}
+
+void
+StoreDistance::violation(Addr store_PC, InstSeqNum store_seq_num,
+                         Addr load_PC, InstSeqNum load_seq_num, ThreadID tid)
+{
+    // Count the stores from the violating one up to the load.
+    const auto &history = storeHistory[tid];
+    auto store_it = std::lower_bound(history.begin(), history.end(),
+                                     store_seq_num);
+    if (store_it == history.end() || *store_it != store_seq_num) {
+        DPRINTF(StoreSet, "StoreDistance: store [sn:%lli] no longer in "
+                "the store history\n", store_seq_num);
+        return;
+    }
+
+    auto load_it = std::lower_bound(store_it, history.end(), load_seq_num);
+    unsigned distance = load_it - store_it;
+    assert(distance > 0);
+
+    // Keep the shortest distance seen, so the load waits on the youngest
+    // store it has conflicted with.
+    unsigned &entry = distanceTable[calcIndex(load_PC)];
+    if (entry == 0 || distance < entry)
+        entry = distance;
+
+    DPRINTF(StoreSet, "StoreDistance: load %#x conflicted with store %#x "
+            "%i stores back, predicting distance %i\n",
+            load_PC, store_PC, distance, entry);
+}
+
+void
+StoreDistance::insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                           ThreadID tid)
+{
+    if (++storesInserted > clearPeriod) {
+        DPRINTF(StoreSet, "Wiping predictor state beacuse %d stores "
+                "inserted\n", clearPeriod);
+        clear();
+    }
+
+    storeHistory[tid].push_back(store_seq_num);
+    if (storeHistory[tid].size() > maxDistance)
+        storeHistory[tid].pop_front();
+}
+
+void
+StoreDistance::checkInst(Addr PC, ThreadID tid,
+                         std::vector<InstSeqNum> &producers)
+{
+    unsigned distance = distanceTable[calcIndex(PC)];
+    const auto &history = storeHistory[tid];
+
+    if (distance == 0 || distance > history.size())
+        return;
+
+    DPRINTF(StoreSet, "StoreDistance: inst %#x depends on the store %i "
+            "back, [sn:%lli]\n", PC, distance,
+            history[history.size() - distance]);
+
+    producers.push_back(history[history.size() - distance]);
+}
+
+void
+StoreDistance::squash(InstSeqNum squashed_num, ThreadID tid)
+{
+    while (!storeHistory[tid].empty() &&
+           storeHistory[tid].back() > squashed_num) {
+        storeHistory[tid].pop_back();
+    }
+}
+
+void
+StoreDistance::clear()
+{
+    std::fill(distanceTable.begin(), distanceTable.end(), 0);
+    storesInserted = 0;
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,85 @@
+#ifndef __CPU_O3_STORE_DISTANCE_HH__
+#define __CPU_O3_STORE_DISTANCE_HH__
+
+#include <deque>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/o3/limits.hh"
+#include "cpu/o3/mem_dep_pred.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Implements a store distance predictor. Each load PC that caused an
+ * ordering violation remembers how many stores back, in program order,
+ * the conflicting store was, and later instances of the load are made
+ * to wait on the store at that distance. See "Speculation Techniques
+ * for Improving Load Related Instruction Scheduling" by Yoaz et al.
+ */
+class StoreDistance : public MemDepPredictor
+{
+  public:
+    /** Creates a store distance predictor.
+     * @param clear_period Number of stores between table wipes.
+     * @param table_size Number of load entries, a power of 2.
+     * @param max_distance Number of recent stores remembered per thread.
+     */
+    StoreDistance(uint64_t clear_period, int table_size,
+                  unsigned max_distance);
+
+    void violation(Addr store_PC, InstSeqNum store_seq_num,
+                   Addr load_PC, InstSeqNum load_seq_num,
+                   ThreadID tid) override;
+
+    void insertStore(Addr store_PC, InstSeqNum store_seq_num,
+                     ThreadID tid) override;
+
+    void checkInst(Addr PC, ThreadID tid,
+                   std::vector<InstSeqNum> &producers) override;
+
+    void issued(Addr issued_PC, InstSeqNum issued_seq_num,
+                bool is_store) override {}
+
+    void squash(InstSeqNum squashed_num, ThreadID tid) override;
+
+    void clear() override;
+
+  private:
+    /** Calculates the index into the distance table based on the PC. */
+    inline int calcIndex(Addr PC) const
+    { return (PC >> offsetBits) & indexMask; }
+
+    /** Store distance of each load, 0 if the load has no dependence. */
+    std::vector<unsigned> distanceTable;
+
+    /** Sequence numbers of the most recently inserted stores, oldest
+     * first.
+     */
+    std::deque<InstSeqNum> storeHistory[MaxThreads];
+
+    /** Number of stores to process before wiping the table. */
+    uint64_t clearPeriod;
+
+    /** Number of stores inserted since the last wipe. */
+    uint64_t storesInserted = 0;
+
+    /** Largest distance that can be predicted. */
+    unsigned maxDistance;
+
+    /** Mask to obtain the index. */
+    int indexMask;
+
+    // HACK: Hardcoded for now, as in StoreSet.
+    int offsetBits = 2;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_STORE_DISTANCE_HH__
@@ -117,7 +117,8 @@ StoreSet::init(uint64_t clear_period, int _SSIT_size, int _LFST_size)
 
 
 void
-StoreSet::violation(Addr store_PC, Addr load_PC)
+StoreSet::violation(Addr store_PC, InstSeqNum store_seq_num,
+                    Addr load_PC, InstSeqNum load_seq_num, ThreadID tid)
 {
     int load_index = calcIndex(load_PC);
     int store_index = calcIndex(store_PC);
@@ -239,8 +240,9 @@ StoreSet::insertStore(Addr store_PC, InstSeqNum store_seq_num, ThreadID tid)
     }
 }
 
-InstSeqNum
-StoreSet::checkInst(Addr PC)
+void
+StoreSet::checkInst(Addr PC, ThreadID tid,
+                    std::vector<InstSeqNum> &producers)
 {
     int index = calcIndex(PC);
 
@@ -251,9 +253,6 @@ StoreSet::checkInst(Addr PC)
     if (!validSSIT[index]) {
         DPRINTF(StoreSet, "Inst %#x with index %i had no SSID\n",
                 PC, index);
-
-        // Return 0 if there's no valid entry.
-        return 0;
     } else {
         inst_SSID = SSIT[index];
 
@@ -263,13 +262,11 @@ StoreSet::checkInst(Addr PC)
 
             DPRINTF(StoreSet, "Inst %#x with index %i and SSID %i had no "
                     "dependency\n", PC, index, inst_SSID);
-
-            return 0;
         } else {
             DPRINTF(StoreSet, "Inst %#x with index %i and SSID %i had LFST "
                     "inum of %i\n", PC, index, inst_SSID, LFST[inst_SSID]);
 
-            return LFST[inst_SSID];
+            producers.push_back(LFST[inst_SSID]);
         }
     }
 }
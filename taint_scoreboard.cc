@@ -1,6 +1,10 @@
 #include "cpu/o3/taint_scoreboard.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/cpu.hh"
+#include "base/trace.hh"
+#include "debug/DVR.hh"
+#include "enums/OpClass.hh"
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 
@@ -16,7 +20,8 @@ TaintScoreboard::TaintScoreboard(unsigned numPhysRegs)
       hasActiveSession(false),
       numTaintedRegs(0),
       numTaintPropagations(0),
-      numDetectedPatterns(0)
+      numDetectedPatterns(0),
+      lastWriterPC(numPhysRegs, 0)
 {
     // ensure vector size is enough
     if (numPhysRegs == 0) {
@@ -25,6 +30,64 @@ TaintScoreboard::TaintScoreboard(unsigned numPhysRegs)
     }
 }
 
+std::string
+TaintScoreboard::name() const
+{
+    return cpu->name() + ".taintScoreboard";
+}
+
+void
+TaintScoreboard::initSliceTable(unsigned size)
+{
+    sliceTableSize = size;
+    slicePCs.clear();
+    sliceOrder.clear();
+}
+
+void
+TaintScoreboard::addSlicePC(Addr pc)
+{
+    if (sliceTableSize == 0 || !slicePCs.insert(pc).second) {
+        return;
+    }
+
+    sliceOrder.push_back(pc);
+    if (sliceOrder.size() > sliceTableSize) {
+        slicePCs.erase(sliceOrder.front());
+        sliceOrder.pop_front();
+    }
+}
+
+void
+TaintScoreboard::markStallingLoad(Addr pc)
+{
+    addSlicePC(pc);
+}
+
+void
+TaintScoreboard::recordSliceProducers(const DynInstPtr& inst)
+{
+    Addr pc = inst->pcState().instAddr();
+
+    // the producers of a slice instruction's sources join the slice
+    if (isSlicePC(pc)) {
+        for (int i = 0; i < inst->numSrcRegs(); i++) {
+            PhysRegIdPtr srcReg = inst->renamedSrcIdx(i);
+            if (srcReg && srcReg->flatIndex() < lastWriterPC.size() &&
+                lastWriterPC[srcReg->flatIndex()] != 0) {
+                addSlicePC(lastWriterPC[srcReg->flatIndex()]);
+            }
+        }
+    }
+
+    for (int i = 0; i < inst->numDestRegs(); i++) {
+        PhysRegIdPtr destReg = inst->renamedDestIdx(i);
+        if (destReg && destReg->flatIndex() < lastWriterPC.size()) {
+            lastWriterPC[destReg->flatIndex()] = pc;
+        }
+    }
+}
+
 void
 TaintScoreboard::taintReg(PhysRegIdPtr destReg, Addr pc)
 {
@@ -120,13 +183,15 @@ TaintScoreboard::propagateTaint(const DynInstPtr& inst)
             hasTaintedSrc = true;
             taintedSrcReg = srcReg;
             
-            // when instruction is added to dependency chain, decode and print instruction information
+            // when instruction is added to dependency chain, remember which
+            // operand carries the chain value for the writeback decode
             if (hasTaintedSrc) {
-                const auto *si = inst->staticInst.get();
-                uint32_t machineInst = si->getRawInst();
-                
-                // decode and print instruction information
-                decodeDependencyChain(currentPC, machineInst);
+                DPRINTF(DVR, "Chain instruction at PC %#x: %s (%s)\n",
+                        currentPC,
+                        inst->staticInst->disassemble(currentPC),
+                        enums::OpClassStrings[inst->opClass()]);
+
+                chainSrcIdx[currentPC] = i;
                 
                 // add current instruction to dependency chain
                 activeSession.dependencyChain.insert(currentPC);
@@ -347,70 +412,6 @@ TaintScoreboard::getStrideValue(Addr pc) const
     return 0;
 }
 
-void
-TaintScoreboard::decodeDependencyChain(Addr pc, uint32_t inst) const
-{
-    // RISC-V 指令格式解析
-    uint32_t opcode = inst & 0x7f;
-    uint32_t rd = (inst >> 7) & 0x1f;
-    uint32_t rs1 = (inst >> 15) & 0x1f;
-    uint32_t rs2 = (inst >> 20) & 0x1f;
-    uint32_t funct3 = (inst >> 12) & 0x7;
-    uint32_t funct7 = (inst >> 25) & 0x7f;
-    
-    printf("DVR: Instruction at PC 0x%lx:\n", pc);
-    printf("DVR:   Raw instruction: 0x%08x\n", inst);
-    printf("DVR:   Opcode: 0x%02x\n", opcode);
-    printf("DVR:   rd: x%d\n", rd);
-    printf("DVR:   rs1: x%d\n", rs1);
-    printf("DVR:   rs2: x%d\n", rs2);
-    printf("DVR:   funct3: 0x%x\n", funct3);
-    printf("DVR:   funct7: 0x%x\n", funct7);
-    
-    // 解析指令类型
-    switch(opcode) {
-        case 0x33:  // R-type
-            printf("DVR:   Type: R-type\n");
-            switch(funct3) {
-                case 0x0:
-                    if (funct7 == 0x00) printf("DVR:   Operation: add rd, rs1, rs2\n");
-                    else if (funct7 == 0x20) printf("DVR:   Operation: sub rd, rs1, rs2\n");
-                    break;
-                case 0x1: printf("DVR:   Operation: sll rd, rs1, rs2\n"); break;
-                case 0x2: printf("DVR:   Operation: slt rd, rs1, rs2\n"); break;
-                case 0x4: printf("DVR:   Operation: xor rd, rs1, rs2\n"); break;
-                case 0x5:
-                    if (funct7 == 0x00) printf("DVR:   Operation: srl rd, rs1, rs2\n");
-                    else if (funct7 == 0x20) printf("DVR:   Operation: sra rd, rs1, rs2\n");
-                    break;
-                case 0x6: printf("DVR:   Operation: or rd, rs1, rs2\n"); break;
-                case 0x7: printf("DVR:   Operation: and rd, rs1, rs2\n"); break;
-            }
-            break;
-            
-        case 0x13:  // I-type
-            {
-                int32_t imm = ((int32_t)inst) >> 20;
-                printf("DVR:   Type: I-type\n");
-                printf("DVR:   Immediate: %d (0x%x)\n", imm, imm);
-                switch(funct3) {
-                    case 0x0: printf("DVR:   Operation: addi rd, rs1, imm\n"); break;
-                    case 0x1: printf("DVR:   Operation: slli rd, rs1, imm\n"); break;
-                    case 0x2: printf("DVR:   Operation: slti rd, rs1, imm\n"); break;
-                    case 0x4: printf("DVR:   Operation: xori rd, rs1, imm\n"); break;
-                    case 0x5:
-                        if (funct7 == 0x00) printf("DVR:   Operation: srli rd, rs1, imm\n");
-                        else if (funct7 == 0x20) printf("DVR:   Operation: srai rd, rs1, imm\n");
-                        break;
-                    case 0x6: printf("DVR:   Operation: ori rd, rs1, imm\n"); break;
-                    case 0x7: printf("DVR:   Operation: andi rd, rs1, imm\n"); break;
-                }
-            }
-            break;
-    }
-    printf("\n");
-}
-
 const std::vector<TaintScoreboard::ComputeStep>* 
 TaintScoreboard::getComputeSteps(Addr pc) const 
 {
@@ -431,23 +432,17 @@ TaintScoreboard::recomputeStepsForPC(Addr pc, uint64_t initValue)
         for (auto& step : it->second) {
             uint64_t oldValue = currentValue;  // 保存原值用于打印
             
-            if (step.operation == "slli") {
-                currentValue = currentValue << step.operand2;
-                printf("DVR: Recompute step at PC %#lx: %s %#lx << %d -> %#lx (%s)\n",
-                       step.pc, step.operation.c_str(), oldValue, step.operand2, 
-                       currentValue, step.description.c_str());
-            } else if (step.operation == "add") {
-                currentValue = currentValue + step.operand2;
-                printf("DVR: Recompute step at PC %#lx: %s %#lx + %#lx -> %#lx (%s)\n",
-                       step.pc, step.operation.c_str(), oldValue, step.operand2, 
-                       currentValue, step.description.c_str());
-            } else if (step.operation == "lw") {
-                // 对于 load 指令,我们使用计算出的地址作为结果
-                currentValue = currentValue + step.operand2;
-                printf("DVR: Recompute step at PC %#lx: %s base=%#lx + offset=%#lx -> addr=%#lx (%s)\n",
-                       step.pc, step.operation.c_str(), oldValue, step.operand2, 
-                       currentValue, step.description.c_str());
+            if (step.operation.empty()) {
+                continue;
             }
+
+            // shifts, adds and address generation are all affine in
+            // the chain value
+            currentValue = currentValue * step.scale + step.operand2;
+            DPRINTF(DVR, "Recompute step at PC %#x: %s %#x * %#x + %#x "
+                    "-> %#x (%s)\n", step.pc, step.operation, oldValue,
+                    step.scale, step.operand2, currentValue,
+                    step.description);
             
             // 更新步骤中的值
             step.operand1 = oldValue;  // 保存输入值
@@ -521,58 +516,41 @@ TaintScoreboard::decodeChainInstructionOperands(Addr pc, const DynInstPtr& inst)
         return;
     }
     
-    uint32_t machineInst = si->getRawInst();
-    
-    // 解析指令格式
-    uint32_t opcode = machineInst & 0x7f;
-    uint32_t funct3 = (machineInst >> 12) & 0x7;
-    uint32_t funct7 = (machineInst >> 25) & 0x7f;
-    int32_t imm = ((int32_t)machineInst) >> 20;
-    
-    // printf("DVR: Raw instruction: 0x%08x\n", machineInst);
-    // printf("DVR: Opcode: 0x%02x, funct3: 0x%x, funct7: 0x%x\n", opcode, funct3, funct7);
-    
-    // 初始化变量
-    std::string operation;
-    uint64_t operand2 = 0;
-    std::string description;
-    
-    // 根据指令类型进行特殊处理
-    switch(opcode) {
-        case 0x0a:  // slli
-        {
-            operation = "slli";
-            operand2 = 2;
-            description = "Left shift by " + std::to_string(operand2);
-            break;
-        }
-        
-        case 0x32:  // add
-        {
-            operation = "add";
-            // get the value of the second source operand
-            uint64_t value = 0;
-            inst->getRegOperand(inst->staticInst.get(), 1, &value);
-            //printf operand2
-            // printf("DVR: Operand2: %#lx\n", value);
-            operand2 = value;
-            description = "Add base and offset";
-            break;
-        }
-        
-        case 0x03:  // Load
-        {
-            operation = "lw";
-            operand2 = imm;
-            description = "Load from memory: base + " + std::to_string(operand2);
-            // printf("DVR: Offset: %#lx\n", operand2);
-            break;
-        }
-        
-        default:
-            printf("DVR: Other instruction type (opcode: 0x%02x)\n", opcode);
-            return;  // 不保存未识别的指令
+    // The stride load's own result is the lane value.
+    auto src = chainSrcIdx.find(pc);
+    if (pc == stridePC || src == chainSrcIdx.end() || inst->isSquashed()) {
+        return;
     }
+
+    // Only integer arithmetic and address generation are replayed on
+    // lane values; the op class and operand types say which this is.
+    ThreadID tid = inst->threadNumber;
+    OpClass opClass = inst->opClass();
+    bool isLoad = inst->isLoad();
+    bool isArith = (opClass == IntAluOp || opClass == IntMultOp) &&
+        inst->numDestRegs() > 0 && inst->destRegIdx(0).is(IntRegClass);
+
+    if ((!isLoad && !isArith) || (isLoad && !inst->effAddrValid()) ||
+        !inst->srcRegIdx(src->second).is(IntRegClass)) {
+        DPRINTF(DVR, "Unsupported chain instruction at PC %#x (%s)\n",
+                pc, enums::OpClassStrings[opClass]);
+        return;
+    }
+
+    uint64_t in = cpu->getReg(inst->renamedSrcIdx(src->second), tid);
+    uint64_t out = isLoad ? inst->effAddr :
+        cpu->getReg(inst->renamedDestIdx(0), tid);
+
+    AffineFit &fit = chainFits[pc];
+    if (!fit.observe(in, out)) {
+        return;
+    }
+    uint64_t scale = fit.scale;
+    uint64_t operand2 = fit.offset;
+
+    std::string operation = isLoad ? "load" : "affine";
+    std::string description = isLoad ? "Address of dependent access" :
+        si->disassemble(pc);
     
     // 按顺序保存计算步骤到当前会话和computeStepsByPC
     if (stridePC != 0 && !operation.empty()) {
@@ -597,6 +575,7 @@ TaintScoreboard::decodeChainInstructionOperands(Addr pc, const DynInstPtr& inst)
                 description
             );
             
+            step.scale = scale;
             steps[position] = step;
             
             // 检查computeStepsByPC中是否已经存在该PC的步骤，避免重复
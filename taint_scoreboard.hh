@@ -1,14 +1,17 @@
 #ifndef __CPU_O3_TAINT_SCOREBOARD_HH__
 #define __CPU_O3_TAINT_SCOREBOARD_HH__
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <set>
+#include <string>
 #include <unordered_set>
 #include "cpu/reg_class.hh"
 #include "base/types.hh"
 #include "base/refcnt.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/lane_value.hh"
 
 namespace gem5
 {
@@ -29,6 +32,8 @@ public:
         uint64_t operand2;
         uint64_t result;
         std::string description;
+        // a step maps its chain input v to v * scale + operand2
+        uint64_t scale = 1;
 
         ComputeStep(Addr _pc, const std::string& _op, uint64_t _op1, uint64_t _op2, 
                     uint64_t _res, const std::string& _desc)
@@ -51,6 +56,9 @@ public:
     
     // 设置CPU指针
     void setCPU(CPU *cpu_ptr) { cpu = cpu_ptr; }
+
+    // Name of the scoreboard, for DPRINTF
+    std::string name() const;
     
     // 第一步：标记寄存器为污点
     void taintReg(PhysRegIdPtr destReg, Addr pc);
@@ -115,6 +123,29 @@ public:
     
     // 在writeback阶段解码依赖链指令的操作数
     void decodeChainInstructionOperands(Addr pc, const DynInstPtr& inst);
+
+    // Precise Runahead: backward slices of loads that stall the ROB.
+    // A slice grows one producer level each time its instructions are
+    // renamed again, following the last writer PC of their sources.
+    void initSliceTable(unsigned size);
+
+    // Add a stalling load as the root of a slice
+    void markStallingLoad(Addr pc);
+
+    // Called at rename: extend slices to the producers of slice
+    // instructions, then record this instruction as its dests' writer
+    void recordSliceProducers(const DynInstPtr& inst);
+
+    // Check whether a PC is a DVR chain instruction, whose chain source
+    // is read again at writeback
+    bool isChainPC(Addr pc) const {
+        return chainSrcIdx.find(pc) != chainSrcIdx.end();
+    }
+
+    // Check whether a PC is on the backward slice of a stalling load
+    bool isSlicePC(Addr pc) const {
+        return slicePCs.find(pc) != slicePCs.end();
+    }
     
 private:
     // CPU指针，用于访问CPU的方法
@@ -144,8 +175,13 @@ private:
     int numTaintPropagations = 0;
     int numDetectedPatterns = 0;
     
-    // 添加解码函数声明
-    void decodeDependencyChain(Addr pc, uint32_t inst) const;
+    // Index of the source operand carrying the chain value, per chain
+    // PC, recorded at rename while the taint is known
+    std::map<Addr, int> chainSrcIdx;
+
+    // Affine fit of a chain instruction's output to its chain input,
+    // made from the values seen at writeback
+    std::map<Addr, AffineFit> chainFits;
     
     // 存储污点寄存器的值
     std::map<int, uint64_t> taintedValues;
@@ -159,6 +195,17 @@ private:
     // 存储正确的操作数值，用于后续比较
     std::map<Addr, std::map<int, uint64_t>> correctOperandValues;
 
+    // Add a PC to the slice table, evicting the oldest one when full
+    void addSlicePC(Addr pc);
+
+    // PC of the last renamed writer of each physical register (flat index)
+    std::vector<Addr> lastWriterPC;
+
+    // PCs on load slices, and their insertion order for FIFO replacement
+    std::unordered_set<Addr> slicePCs;
+    std::deque<Addr> sliceOrder;
+    unsigned sliceTableSize = 0;
+
 };
 
 } // namespace o3
@@ -0,0 +1,112 @@
+#include "cpu/o3/value_pred.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/ValuePred.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+LoadValuePredictor::LoadValuePredictor(const std::string &name,
+                                       unsigned table_size,
+                                       unsigned conf_threshold)
+{
+    init(name, table_size, conf_threshold);
+}
+
+void
+LoadValuePredictor::init(const std::string &name, unsigned table_size,
+                         unsigned conf_threshold)
+{
+    _name = name;
+
+    if (!isPowerOf2(table_size)) {
+        fatal("Invalid load value predictor table size!\n");
+    }
+
+    if (conf_threshold > maxConfidence) {
+        fatal("Load value predictor confidence threshold (%u) is larger "
+              "than the counter maximum (%u)\n", conf_threshold,
+              maxConfidence);
+    }
+
+    table.resize(table_size);
+    indexMask = table_size - 1;
+    confThreshold = conf_threshold;
+}
+
+LoadValuePredictor::Entry *
+LoadValuePredictor::findEntry(Addr load_pc)
+{
+    Entry &entry = table[calcIndex(load_pc)];
+    return entry.valid && entry.tag == load_pc ? &entry : nullptr;
+}
+
+bool
+LoadValuePredictor::predict(Addr load_pc, RegVal &value)
+{
+    Entry *entry = findEntry(load_pc);
+
+    if (!entry) {
+        // Allocate on first sight; the entry becomes useful once the
+        // load has been seen with a stable stride a few times.
+        entry = &table[calcIndex(load_pc)];
+        *entry = Entry();
+        entry->valid = true;
+        entry->tag = load_pc;
+        entry->inflight = 1;
+        return false;
+    }
+
+    value = entry->lastValue + entry->stride * (entry->inflight + 1);
+    entry->inflight++;
+
+    return entry->confidence >= confThreshold;
+}
+
+void
+LoadValuePredictor::update(Addr load_pc, RegVal value, bool mispredicted)
+{
+    Entry *entry = findEntry(load_pc);
+
+    // The entry was replaced since the lookup.
+    if (!entry)
+        return;
+
+    if (entry->inflight)
+        entry->inflight--;
+
+    RegVal stride = value - entry->lastValue;
+    if (stride == entry->stride) {
+        if (entry->confidence < maxConfidence)
+            entry->confidence++;
+    } else {
+        entry->confidence = 0;
+        entry->stride = stride;
+    }
+
+    if (mispredicted)
+        entry->confidence = 0;
+
+    entry->lastValue = value;
+
+    DPRINTF(ValuePred, "PC %#x value %#x stride %#x "
+            "confidence %u.\n", load_pc, value, entry->stride,
+            entry->confidence);
+}
+
+void
+LoadValuePredictor::release(Addr load_pc)
+{
+    Entry *entry = findEntry(load_pc);
+
+    if (entry && entry->inflight)
+        entry->inflight--;
+}
+
+} // namespace o3
+} // namespace gem5
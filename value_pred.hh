@@ -0,0 +1,97 @@
+#ifndef __CPU_O3_VALUE_PRED_HH__
+#define __CPU_O3_VALUE_PRED_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Last-value plus stride load value predictor. Entries are indexed by
+ * load PC and hold the last value seen, the stride between the last two
+ * values and a saturating confidence counter. A prediction is only
+ * offered once the counter reaches the confidence threshold.
+ *
+ * Several instances of the same load can be in flight at once, so each
+ * entry also counts the lookups that have not been resolved yet and
+ * predicts that many strides past the last value.
+ */
+class LoadValuePredictor
+{
+  public:
+    /** Default constructor.  init() must be called prior to use. */
+    LoadValuePredictor() { };
+
+    /** Creates a value predictor with the given table size. */
+    LoadValuePredictor(const std::string &name, unsigned table_size,
+                       unsigned conf_threshold);
+
+    /** Initializes the value predictor with the given table size. */
+    void init(const std::string &name, unsigned table_size,
+              unsigned conf_threshold);
+
+    /**
+     * Looks up the value of a load about to be dispatched. Every lookup
+     * must be followed by exactly one call to update() or release().
+     * @param load_pc PC of the load.
+     * @param value Set to the predicted value if confident.
+     * @return Whether the prediction is confident enough to use.
+     */
+    bool predict(Addr load_pc, RegVal &value);
+
+    /** Trains the entry of a load with its actual value. A load whose
+     * confident prediction turned out wrong loses all confidence.
+     */
+    void update(Addr load_pc, RegVal value, bool mispredicted);
+
+    /** Drops a lookup whose load was squashed or faulted, without
+     * training the entry.
+     */
+    void release(Addr load_pc);
+
+    /** Name of the predictor, for DPRINTF. */
+    const std::string &name() const { return _name; }
+
+  private:
+    struct Entry
+    {
+        bool valid = false;
+        Addr tag = 0;
+        RegVal lastValue = 0;
+        RegVal stride = 0;
+        unsigned confidence = 0;
+        unsigned inflight = 0;
+    };
+
+    /** Returns the entry for a PC, or nullptr if it is not present. */
+    Entry *findEntry(Addr load_pc);
+
+    /** Returns the table index of a PC. */
+    unsigned calcIndex(Addr load_pc) const
+    {
+        return (load_pc >> 1) & indexMask;
+    }
+
+    std::string _name;
+
+    std::vector<Entry> table;
+
+    unsigned indexMask;
+
+    /** Confidence needed before a prediction is used. */
+    unsigned confThreshold;
+
+    /** Saturation value of the confidence counters. */
+    static constexpr unsigned maxConfidence = 15;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_VALUE_PRED_HH__
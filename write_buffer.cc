@@ -0,0 +1,110 @@
+#include "cpu/o3/write_buffer.hh"
+
+#include <cassert>
+#include <cstring>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+StoreWriteBuffer::init(unsigned num_entries, unsigned line_size,
+                       bool in_order_merge)
+{
+    numEntries = num_entries;
+    lineSize = line_size;
+    inOrderMerge = in_order_merge;
+    entries.clear();
+}
+
+int
+StoreWriteBuffer::findMergeEntry(Addr line_addr) const
+{
+    if (entries.empty())
+        return -1;
+
+    if (inOrderMerge) {
+        return entries.back().lineAddr == line_addr ?
+            entries.size() - 1 : -1;
+    }
+
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i].lineAddr == line_addr)
+            return i;
+    }
+    return -1;
+}
+
+bool
+StoreWriteBuffer::canInsert(Addr paddr, unsigned size) const
+{
+    if (!enabled() || size == 0 ||
+        lineAddr(paddr) != lineAddr(paddr + size - 1)) {
+        return false;
+    }
+
+    return !full() || findMergeEntry(lineAddr(paddr)) >= 0;
+}
+
+bool
+StoreWriteBuffer::insert(Addr paddr, const uint8_t *data, unsigned size)
+{
+    assert(canInsert(paddr, size));
+
+    Addr line_addr = lineAddr(paddr);
+    int idx = findMergeEntry(line_addr);
+    bool merged = idx >= 0;
+
+    if (!merged) {
+        entries.push_back({line_addr, std::vector<uint8_t>(lineSize, 0),
+                           std::vector<bool>(lineSize, false), 0, 0});
+        idx = entries.size() - 1;
+    }
+    Entry *entry = &entries[idx];
+
+    unsigned offset = paddr - line_addr;
+    if (data)
+        std::memcpy(entry->data.data() + offset, data, size);
+    else
+        std::memset(entry->data.data() + offset, 0, size);
+
+    for (unsigned i = offset; i < offset + size; ++i) {
+        if (!entry->byteEnable[i]) {
+            entry->byteEnable[i] = true;
+            ++entry->validBytes;
+        }
+    }
+    ++entry->numStores;
+
+    return merged;
+}
+
+StoreWriteBuffer::Coverage
+StoreWriteBuffer::lookup(Addr paddr, unsigned size, uint8_t *data) const
+{
+    unsigned found = 0;
+
+    for (unsigned i = 0; i < size; ++i) {
+        Addr byte_addr = paddr + i;
+        Addr line_addr = lineAddr(byte_addr);
+        unsigned offset = byte_addr - line_addr;
+
+        // The youngest entry holding a byte has its latest value.
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+            if (it->lineAddr == line_addr && it->byteEnable[offset]) {
+                data[i] = it->data[offset];
+                ++found;
+                break;
+            }
+        }
+    }
+
+    if (found == 0)
+        return Coverage::None;
+    return found == size ? Coverage::Full : Coverage::Partial;
+}
+
+} // namespace o3
+} // namespace gem5
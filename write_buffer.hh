@@ -0,0 +1,117 @@
+#ifndef __CPU_O3_WRITE_BUFFER_HH__
+#define __CPU_O3_WRITE_BUFFER_HH__
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Post-commit coalescing write buffer. Committed stores leave the store
+ * queue as soon as they are written into a line-sized entry, and stores
+ * to a line that already has an entry merge into it. Entries drain to the
+ * cache oldest first as single line writes carrying a byte mask.
+ *
+ * With in-order merging (TSO) a store may only merge into the youngest
+ * entry, so that draining in order never makes a store visible before an
+ * older store to another line. Several entries may then hold the same
+ * line, and lookups give the youngest bytes priority.
+ */
+class StoreWriteBuffer
+{
+  public:
+    /** A buffered cache line. */
+    struct Entry
+    {
+        Addr lineAddr;
+        std::vector<uint8_t> data;
+        std::vector<bool> byteEnable;
+        /** Number of bytes written so far. */
+        unsigned validBytes;
+        /** Number of stores merged into the line. */
+        unsigned numStores;
+    };
+
+    /** How much of a load a lookup found in the buffer. */
+    enum class Coverage
+    {
+        None,
+        Partial,
+        Full
+    };
+
+    /** Default constructor.  init() must be called prior to use. */
+    StoreWriteBuffer() { };
+
+    /** Initializes the buffer.
+     * @param num_entries Number of lines held; 0 disables the buffer.
+     * @param line_size Cache line size in bytes.
+     * @param in_order_merge Whether stores may only merge into the
+     * youngest entry.
+     */
+    void init(unsigned num_entries, unsigned line_size, bool in_order_merge);
+
+    /** Returns whether the buffer is in use. */
+    bool enabled() const { return numEntries != 0; }
+
+    bool empty() const { return entries.empty(); }
+
+    bool full() const { return entries.size() >= numEntries; }
+
+    /** Returns whether a store of the given size at the given physical
+     * address can be written into the buffer this cycle.
+     */
+    bool canInsert(Addr paddr, unsigned size) const;
+
+    /** Writes a store into the buffer. canInsert() must be true.
+     * @param data The store data, or nullptr if it is all zeros.
+     * @return Whether the store merged into an existing entry.
+     */
+    bool insert(Addr paddr, const uint8_t *data, unsigned size);
+
+    /** Looks up a load, copying whatever buffered bytes it covers into
+     * data.
+     */
+    Coverage lookup(Addr paddr, unsigned size, uint8_t *data) const;
+
+    /** Returns the oldest entry. */
+    const Entry &front() const { return entries.front(); }
+
+    /** Returns whether the oldest entry has every byte written. */
+    bool frontComplete() const
+    { return entries.front().validBytes == lineSize; }
+
+    /** Removes the oldest entry once it has been sent to the cache. */
+    void popFront() { entries.pop_front(); }
+
+    void clear() { entries.clear(); }
+
+  private:
+    /** Returns the index of the entry a store to the given line would
+     * merge into, or -1 if it needs a new one.
+     */
+    int findMergeEntry(Addr line_addr) const;
+
+    Addr lineAddr(Addr paddr) const { return paddr & ~Addr(lineSize - 1); }
+
+    /** Buffered lines, oldest first. */
+    std::deque<Entry> entries;
+
+    unsigned numEntries = 0;
+
+    unsigned lineSize = 0;
+
+    bool inOrderMerge = false;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_WRITE_BUFFER_HH__